@@ -0,0 +1,163 @@
+// Copyright (c) 2016-2026 The Karbowanec developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// Scaffolding shared by the headless benchmarks: timing, the command line
+// thread list, one pinned worker per thread released together, and the
+// thread scaling table.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CpuTopology.h"
+
+namespace WalletGui {
+namespace Bench {
+
+typedef std::chrono::steady_clock Clock;
+
+inline uint64_t elapsedNs(Clock::time_point _from, Clock::time_point _to) {
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(_to - _from).count());
+}
+
+inline double ratePerSecond(uint64_t _count, uint64_t _ns) {
+  return _ns == 0 ? 0.0 : static_cast<double>(_count) * 1e9 / static_cast<double>(_ns);
+}
+
+inline double averageUs(uint64_t _ns, uint64_t _count) {
+  return _count == 0 ? 0.0 : static_cast<double>(_ns) / 1e3 / static_cast<double>(_count);
+}
+
+inline bool parseThreadList(const std::string& _value, std::vector<uint32_t>& _threads) {
+  std::istringstream stream(_value);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    const long count = std::strtol(item.c_str(), nullptr, 10);
+    if (count <= 0) {
+      return false;
+    }
+
+    _threads.push_back(static_cast<uint32_t>(count));
+  }
+
+  return !_threads.empty();
+}
+
+inline uint32_t hardwareThreadCount() {
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// 1 and powers of two up to the CPU count
+inline std::vector<uint32_t> defaultThreadCounts() {
+  const uint32_t hardwareThreads = hardwareThreadCount();
+  std::vector<uint32_t> threadCounts;
+  for (uint32_t count = 1; count < hardwareThreads; count *= 2) {
+    threadCounts.push_back(count);
+  }
+
+  threadCounts.push_back(hardwareThreads);
+  return threadCounts;
+}
+
+// _options and _help describe the options other than --threads
+inline void printUsage(const char* _name, const std::string& _options, const std::string& _help) {
+  std::cout << "Usage: " << _name << " [--threads 1,2,4] " << _options << std::endl
+            << "  --threads   comma separated thread counts to run, default 1 and powers of two up to the CPU count" << std::endl
+            << _help;
+}
+
+// a worker sets itself up, then spins here so every thread starts timing together
+inline void waitForStart(const std::atomic<bool>& _go) {
+  while (!_go.load()) {
+    std::this_thread::yield();
+  }
+}
+
+// Runs _body(index, go, result) on _threads threads, pinned in _cpuOrder when it is
+// not empty, and returns one result per thread. Each body calls waitForStart(go)
+// once its setup is done.
+template<typename Result, typename Body>
+std::vector<Result> runThreads(uint32_t _threads, const std::vector<LogicalCpu>& _cpuOrder, Body _body) {
+  std::vector<Result> results(_threads);
+  std::vector<std::thread> workers;
+  std::atomic<bool> go(false);
+  for (uint32_t i = 0; i < _threads; ++i) {
+    const int32_t cpu = _cpuOrder.empty() ? -1 : static_cast<int32_t>(_cpuOrder[i % _cpuOrder.size()].id);
+    workers.emplace_back([&_body, &go, &results, i, cpu]() {
+      if (cpu >= 0) {
+        pinCurrentThreadToCpu(static_cast<uint32_t>(cpu));
+      }
+
+      _body(i, go, results[i]);
+    });
+  }
+
+  go = true;
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+
+  return results;
+}
+
+struct Column {
+  std::string title;
+  int width;
+};
+
+// Rate, rate per thread and scaling against the first row, followed by the
+// benchmark's own per-stage columns.
+class ScalingTable {
+public:
+  ScalingTable(const Column& _rate, const Column& _perThread, const std::vector<Column>& _stages) :
+    m_rate(_rate), m_perThread(_perThread), m_stages(_stages), m_baseRate(0.0) {
+  }
+
+  void printHeader() const {
+    std::cout << std::left << std::setw(8) << "threads" << std::right
+              << std::setw(m_rate.width) << m_rate.title << std::setw(m_perThread.width) << m_perThread.title
+              << std::setw(12) << "scaling";
+    for (const Column& stage : m_stages) {
+      std::cout << std::setw(stage.width) << stage.title;
+    }
+
+    std::cout << std::endl;
+  }
+
+  // _rate is the sum of the per-thread rates, _stages has one value per stage column
+  void printRow(uint32_t _threads, double _rate, const std::vector<double>& _stages) {
+    const double perThread = _rate / _threads;
+    if (m_baseRate == 0.0) {
+      m_baseRate = perThread;
+    }
+
+    std::cout << std::left << std::setw(8) << _threads << std::right << std::fixed << std::setprecision(2)
+              << std::setw(m_rate.width) << _rate << std::setw(m_perThread.width) << perThread
+              << std::setw(11) << (m_baseRate > 0.0 ? perThread / m_baseRate * 100.0 : 0.0) << "%";
+    for (size_t i = 0; i < m_stages.size() && i < _stages.size(); ++i) {
+      std::cout << std::setw(m_stages[i].width) << _stages[i];
+    }
+
+    std::cout << std::endl;
+  }
+
+private:
+  Column m_rate;
+  Column m_perThread;
+  std::vector<Column> m_stages;
+  double m_baseRate;
+};
+
+}
+}
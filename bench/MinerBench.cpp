@@ -0,0 +1,257 @@
+// Copyright (c) 2016-2026 The Karbowanec developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// Headless benchmark of the solo miner hashing path. It builds a synthetic
+// block template and runs the per-nonce steps of Miner::worker_thread
+// (hashing blob, block signature, long hash) for a fixed number of nonces
+// on a range of thread counts. No node, network or Qt is needed.
+
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/utility/value_init.hpp>
+
+#include <CryptoNoteConfig.h>
+
+#include "crypto/crypto.h"
+#include "crypto/hash.h"
+#include "CryptoNoteCore/CryptoNoteFormatUtils.h"
+#include "CryptoNoteCore/TransactionExtra.h"
+
+#include "BenchCommon.h"
+#include "CpuTopology.h"
+#include "MiningBlob.h"
+
+using namespace CryptoNote;
+using namespace WalletGui;
+using namespace WalletGui::Bench;
+
+namespace {
+
+const uint32_t DEFAULT_NONCES_PER_THREAD = 32;
+const uint32_t BENCH_BLOCK_HEIGHT = 1000000;
+
+struct BenchTemplate {
+  Block block;
+  Crypto::PublicKey ephPubKey;
+  Crypto::SecretKey ephSecKey;
+};
+
+struct ThreadResult {
+  uint64_t hashes = 0;
+  uint64_t blobNs = 0;
+  uint64_t signatureNs = 0;
+  uint64_t longHashNs = 0;
+  uint64_t totalNs = 0;
+  bool failed = false;
+};
+
+bool buildTemplate(uint8_t _majorVersion, BenchTemplate& _tpl) {
+  AccountKeys account;
+  Crypto::generate_keys(account.address.spendPublicKey, account.spendSecretKey);
+  Crypto::generate_keys(account.address.viewPublicKey, account.viewSecretKey);
+
+  Crypto::PublicKey txPublicKey;
+  Crypto::SecretKey txSecretKey;
+  Crypto::generate_keys(txPublicKey, txSecretKey);
+
+  Block& b = _tpl.block;
+  b = boost::value_initialized<Block>();
+  b.majorVersion = _majorVersion;
+  b.minorVersion = 0;
+  b.timestamp = static_cast<uint64_t>(std::time(nullptr));
+  b.previousBlockHash = Crypto::rand<Crypto::Hash>();
+
+  // a coinbase paying to a fresh account, shaped like the one the node returns
+  Transaction& tx = b.baseTransaction;
+  tx.version = CURRENT_TRANSACTION_VERSION;
+  tx.unlockTime = BENCH_BLOCK_HEIGHT + parameters::CRYPTONOTE_MINED_MONEY_UNLOCK_WINDOW;
+
+  BaseInput input;
+  input.blockIndex = BENCH_BLOCK_HEIGHT;
+  tx.inputs.push_back(input);
+
+  Crypto::KeyDerivation derivation;
+  KeyOutput target;
+  if (!Crypto::generate_key_derivation(account.address.viewPublicKey, txSecretKey, derivation) ||
+      !Crypto::derive_public_key(derivation, 0, account.address.spendPublicKey, target.key)) {
+    return false;
+  }
+
+  TransactionOutput output;
+  output.amount = 1000000000000;
+  output.target = target;
+  tx.outputs.push_back(output);
+  addTransactionPublicKeyToExtra(tx.extra, txPublicKey);
+
+  // the same derivation Miner::get_block_signing_keys does once per template
+  Crypto::KeyDerivation minerDerivation;
+  if (!Crypto::generate_key_derivation(txPublicKey, account.viewSecretKey, minerDerivation)) {
+    return false;
+  }
+
+  Crypto::derive_secret_key(minerDerivation, 0, account.spendSecretKey, _tpl.ephSecKey);
+  _tpl.ephPubKey = target.key;
+  return true;
+}
+
+void benchThread(const BenchTemplate& _tpl, uint32_t _index, uint32_t _threads, uint32_t _nonces,
+                 const std::atomic<bool>& _go, ThreadResult& _result) {
+  Crypto::cn_context context;
+  Block b = _tpl.block;
+  BinaryArray hashingBlob;
+  size_t nonceOffset = 0;
+  const bool signedBlock = b.majorVersion >= BLOCK_MAJOR_VERSION_5;
+  if (signedBlock && !get_hashing_blob_with_nonce_offset(b, hashingBlob, nonceOffset)) {
+    _result.failed = true;
+    return;
+  }
+
+  waitForStart(_go);
+
+  // counted in locals, results of neighbouring threads share cache lines
+  ThreadResult result;
+  uint32_t nonce = _index;
+  const Clock::time_point start = Clock::now();
+  for (uint32_t i = 0; i < _nonces; ++i) {
+    b.nonce = nonce;
+
+    const Clock::time_point t0 = Clock::now();
+    Crypto::Hash h;
+    if (signedBlock) {
+      memcpy(hashingBlob.data() + nonceOffset, &nonce, sizeof(nonce));
+      h = Crypto::cn_fast_hash(hashingBlob.data(), hashingBlob.size());
+    }
+
+    const Clock::time_point t1 = Clock::now();
+    if (signedBlock) {
+      Crypto::generate_signature(h, _tpl.ephPubKey, _tpl.ephSecKey, b.signature);
+    }
+
+    const Clock::time_point t2 = Clock::now();
+    Crypto::Hash pow;
+    if (!get_block_longhash(context, b, pow)) {
+      _result.failed = true;
+      return;
+    }
+
+    const Clock::time_point t3 = Clock::now();
+    result.blobNs += elapsedNs(t0, t1);
+    result.signatureNs += elapsedNs(t1, t2);
+    result.longHashNs += elapsedNs(t2, t3);
+    ++result.hashes;
+    nonce += _threads;
+  }
+
+  result.totalNs = elapsedNs(start, Clock::now());
+  _result = result;
+}
+
+bool parseAffinity(const std::string& _value, MiningAffinity& _affinity) {
+  if (_value == "none") {
+    _affinity = MiningAffinity::NONE;
+  } else if (_value == "physical") {
+    _affinity = MiningAffinity::PHYSICAL_FIRST;
+  } else if (_value == "compact") {
+    _affinity = MiningAffinity::COMPACT;
+  } else {
+    return false;
+  }
+
+  return true;
+}
+
+void printUsage(const char* _name) {
+  std::ostringstream help;
+  help << "  --nonces    nonces hashed by every thread, default " << DEFAULT_NONCES_PER_THREAD << std::endl
+       << "  --affinity  thread placement, default physical where pinning is supported" << std::endl
+       << "  --version   block major version of the synthetic template, default " << static_cast<int>(BLOCK_MAJOR_VERSION_5) << std::endl;
+  Bench::printUsage(_name, "[--nonces N] [--affinity none|physical|compact] [--version N]", help.str());
+}
+
+}
+
+int main(int argc, char* argv[]) {
+  std::vector<uint32_t> threadCounts;
+  uint32_t nonces = DEFAULT_NONCES_PER_THREAD;
+  MiningAffinity affinity = isCpuPinningSupported() ? MiningAffinity::PHYSICAL_FIRST : MiningAffinity::NONE;
+  uint8_t majorVersion = BLOCK_MAJOR_VERSION_5;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (arg == "--threads" && hasValue) {
+      if (!parseThreadList(argv[++i], threadCounts)) {
+        printUsage(argv[0]);
+        return 1;
+      }
+    } else if (arg == "--nonces" && hasValue) {
+      nonces = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+    } else if (arg == "--affinity" && hasValue) {
+      if (!parseAffinity(argv[++i], affinity)) {
+        printUsage(argv[0]);
+        return 1;
+      }
+    } else if (arg == "--version" && hasValue) {
+      majorVersion = static_cast<uint8_t>(std::strtoul(argv[++i], nullptr, 10));
+    } else {
+      printUsage(argv[0]);
+      return arg == "--help" ? 0 : 1;
+    }
+  }
+
+  if (nonces == 0) {
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  if (threadCounts.empty()) {
+    threadCounts = defaultThreadCounts();
+  }
+
+  BenchTemplate tpl;
+  if (!buildTemplate(majorVersion, tpl)) {
+    std::cerr << "Failed to build a synthetic block template" << std::endl;
+    return 1;
+  }
+
+  const std::vector<LogicalCpu> cpuOrder = getMiningCpuOrder(affinity);
+  std::cout << "Block v" << static_cast<int>(majorVersion) << ", " << nonces << " nonce(s) per thread, "
+            << hardwareThreadCount() << " hardware thread(s)" << std::endl;
+  std::cout << "The long hash stage does not sample a chain, it times the hashing of the block itself" << std::endl << std::endl;
+  ScalingTable table({"H/s", 12}, {"H/s/thread", 14}, {{"blob us", 12}, {"sign us", 12}, {"longhash us", 14}});
+  table.printHeader();
+
+  for (uint32_t threads : threadCounts) {
+    const std::vector<ThreadResult> results = runThreads<ThreadResult>(threads, cpuOrder,
+      [&tpl, threads, nonces](uint32_t _index, const std::atomic<bool>& _go, ThreadResult& _result) {
+        benchThread(tpl, _index, threads, nonces, _go, _result);
+      });
+
+    ThreadResult total;
+    double rate = 0.0;
+    for (const ThreadResult& result : results) {
+      if (result.failed) {
+        std::cerr << "Hashing failed, the synthetic template was rejected" << std::endl;
+        return 1;
+      }
+
+      total.hashes += result.hashes;
+      total.blobNs += result.blobNs;
+      total.signatureNs += result.signatureNs;
+      total.longHashNs += result.longHashNs;
+      rate += ratePerSecond(result.hashes, result.totalNs);
+    }
+
+    table.printRow(threads, rate, {averageUs(total.blobNs, total.hashes), averageUs(total.signatureNs, total.hashes),
+      averageUs(total.longHashNs, total.hashes)});
+  }
+
+  return 0;
+}
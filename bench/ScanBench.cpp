@@ -0,0 +1,214 @@
+// Copyright (c) 2016-2026 The Karbowanec developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// Headless benchmark of the view key scanning path used by wallet
+// synchronization: one key derivation per transaction public key and one
+// output key derivation per output, compared against the output target.
+// Reports outputs per second for a range of thread counts, so kernel
+// changes in the crypto library can be measured. No node, network or Qt
+// is needed.
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "crypto/crypto.h"
+
+#include "BenchCommon.h"
+#include "CpuTopology.h"
+
+using namespace WalletGui;
+using namespace WalletGui::Bench;
+
+namespace {
+
+const uint32_t DEFAULT_OUTPUTS_PER_THREAD = 4096;
+const uint32_t DEFAULT_OUTPUTS_PER_TRANSACTION = 2;
+const uint32_t BENCH_TRANSACTIONS = 256;
+
+struct BenchTransaction {
+  Crypto::PublicKey publicKey;
+  std::vector<Crypto::PublicKey> outputKeys;
+};
+
+struct BenchAccount {
+  Crypto::PublicKey spendPublicKey;
+  Crypto::SecretKey spendSecretKey;
+  Crypto::PublicKey viewPublicKey;
+  Crypto::SecretKey viewSecretKey;
+};
+
+struct ThreadResult {
+  uint64_t outputs = 0;
+  uint64_t owned = 0;
+  uint64_t derivationNs = 0;
+  uint64_t outputKeyNs = 0;
+  uint64_t totalNs = 0;
+  bool failed = false;
+};
+
+// every other transaction pays to the scanned account, the rest to a
+// stranger, so both outcomes of the ownership check are exercised
+bool buildTransactions(const BenchAccount& _account, uint32_t _outputsPerTx, std::vector<BenchTransaction>& _txs) {
+  BenchAccount stranger;
+  Crypto::generate_keys(stranger.spendPublicKey, stranger.spendSecretKey);
+  Crypto::generate_keys(stranger.viewPublicKey, stranger.viewSecretKey);
+
+  _txs.resize(BENCH_TRANSACTIONS);
+  for (uint32_t t = 0; t < BENCH_TRANSACTIONS; ++t) {
+    const BenchAccount& recipient = t % 2 == 0 ? _account : stranger;
+    BenchTransaction& tx = _txs[t];
+    Crypto::SecretKey txSecretKey;
+    Crypto::generate_keys(tx.publicKey, txSecretKey);
+
+    Crypto::KeyDerivation derivation;
+    if (!Crypto::generate_key_derivation(recipient.viewPublicKey, txSecretKey, derivation)) {
+      return false;
+    }
+
+    tx.outputKeys.resize(_outputsPerTx);
+    for (uint32_t i = 0; i < _outputsPerTx; ++i) {
+      if (!Crypto::derive_public_key(derivation, i, recipient.spendPublicKey, tx.outputKeys[i])) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+void benchThread(const BenchAccount& _account, const std::vector<BenchTransaction>& _txs, uint32_t _index,
+                 uint32_t _outputs, const std::atomic<bool>& _go, ThreadResult& _result) {
+  waitForStart(_go);
+
+  // counted in locals, results of neighbouring threads share cache lines
+  ThreadResult result;
+  size_t txIndex = _index % _txs.size();
+  const Clock::time_point start = Clock::now();
+  while (result.outputs < _outputs) {
+    const BenchTransaction& tx = _txs[txIndex];
+    txIndex = (txIndex + 1) % _txs.size();
+
+    const Clock::time_point t0 = Clock::now();
+    Crypto::KeyDerivation derivation;
+    if (!Crypto::generate_key_derivation(tx.publicKey, _account.viewSecretKey, derivation)) {
+      _result.failed = true;
+      return;
+    }
+
+    const Clock::time_point t1 = Clock::now();
+    for (size_t i = 0; i < tx.outputKeys.size(); ++i) {
+      Crypto::PublicKey outputKey;
+      if (!Crypto::derive_public_key(derivation, i, _account.spendPublicKey, outputKey)) {
+        _result.failed = true;
+        return;
+      }
+
+      if (outputKey == tx.outputKeys[i]) {
+        ++result.owned;
+      }
+    }
+
+    const Clock::time_point t2 = Clock::now();
+    result.derivationNs += elapsedNs(t0, t1);
+    result.outputKeyNs += elapsedNs(t1, t2);
+    result.outputs += tx.outputKeys.size();
+  }
+
+  result.totalNs = elapsedNs(start, Clock::now());
+  _result = result;
+}
+
+void printUsage(const char* _name) {
+  std::ostringstream help;
+  help << "  --outputs         outputs scanned by every thread, default " << DEFAULT_OUTPUTS_PER_THREAD << std::endl
+       << "  --outputs-per-tx  outputs in every synthetic transaction, default " << DEFAULT_OUTPUTS_PER_TRANSACTION << std::endl;
+  Bench::printUsage(_name, "[--outputs N] [--outputs-per-tx N]", help.str());
+}
+
+}
+
+int main(int argc, char* argv[]) {
+  std::vector<uint32_t> threadCounts;
+  uint32_t outputs = DEFAULT_OUTPUTS_PER_THREAD;
+  uint32_t outputsPerTx = DEFAULT_OUTPUTS_PER_TRANSACTION;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (arg == "--threads" && hasValue) {
+      if (!parseThreadList(argv[++i], threadCounts)) {
+        printUsage(argv[0]);
+        return 1;
+      }
+    } else if (arg == "--outputs" && hasValue) {
+      outputs = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+    } else if (arg == "--outputs-per-tx" && hasValue) {
+      outputsPerTx = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+    } else {
+      printUsage(argv[0]);
+      return arg == "--help" ? 0 : 1;
+    }
+  }
+
+  if (outputs == 0 || outputsPerTx == 0) {
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  if (threadCounts.empty()) {
+    threadCounts = defaultThreadCounts();
+  }
+
+  BenchAccount account;
+  Crypto::generate_keys(account.spendPublicKey, account.spendSecretKey);
+  Crypto::generate_keys(account.viewPublicKey, account.viewSecretKey);
+
+  std::vector<BenchTransaction> txs;
+  if (!buildTransactions(account, outputsPerTx, txs)) {
+    std::cerr << "Failed to build synthetic transactions" << std::endl;
+    return 1;
+  }
+
+  const std::vector<LogicalCpu> cpuOrder = getMiningCpuOrder(isCpuPinningSupported() ? MiningAffinity::PHYSICAL_FIRST : MiningAffinity::NONE);
+  std::cout << outputs << " output(s) per thread, " << outputsPerTx << " output(s) per transaction, "
+            << hardwareThreadCount() << " hardware thread(s)" << std::endl << std::endl;
+  ScalingTable table({"outputs/s", 14}, {"outputs/s/thr", 16}, {{"derivation us", 16}, {"output key us", 16}});
+  table.printHeader();
+
+  for (uint32_t threads : threadCounts) {
+    const std::vector<ThreadResult> results = runThreads<ThreadResult>(threads, cpuOrder,
+      [&account, &txs, outputs](uint32_t _index, const std::atomic<bool>& _go, ThreadResult& _result) {
+        benchThread(account, txs, _index, outputs, _go, _result);
+      });
+
+    ThreadResult total;
+    uint64_t transactions = 0;
+    double rate = 0.0;
+    for (const ThreadResult& result : results) {
+      if (result.failed) {
+        std::cerr << "Key derivation failed on a synthetic transaction" << std::endl;
+        return 1;
+      }
+
+      total.outputs += result.outputs;
+      total.owned += result.owned;
+      total.derivationNs += result.derivationNs;
+      total.outputKeyNs += result.outputKeyNs;
+      transactions += result.outputs / outputsPerTx;
+      rate += ratePerSecond(result.outputs, result.totalNs);
+    }
+
+    if (total.owned == 0) {
+      std::cerr << "No owned output was recognised, the derivation path is broken" << std::endl;
+      return 1;
+    }
+
+    table.printRow(threads, rate, {averageUs(total.derivationNs, transactions), averageUs(total.outputKeyNs, total.outputs)});
+  }
+
+  return 0;
+}
@@ -0,0 +1,350 @@
+// Copyright (c) 2016-2026 The Karbowanec developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "BatchPayout.h"
+
+#include <QHash>
+#include <QRegularExpression>
+#include <QStringList>
+
+#include <algorithm>
+#include <cstring>
+
+#include "CryptoNoteConfig.h"
+#include "Wallet/WalletErrors.h"
+
+#include "CurrencyAdapter.h"
+#include "WalletAdapter.h"
+
+namespace WalletGui {
+
+namespace {
+
+// well under the wallet's own limit and inside the full reward zone, so the
+// estimate below may be off without the transaction being refused or penalized
+const size_t PAYOUT_TRANSACTION_SIZE_TARGET = CryptoNote::parameters::CRYPTONOTE_BLOCK_GRANTED_FULL_REWARD_ZONE / 4;
+// version, unlock time, input and output counts, public key and payment id in extra
+const size_t TRANSACTION_PREFIX_SIZE = 128;
+// tag, amount, ring size and key image
+const size_t INPUT_SIZE = 48;
+// key offset and signature for every ring member
+const size_t RING_MEMBER_SIZE = 5 + 64;
+// tag, amount and key
+const size_t OUTPUT_SIZE = 44;
+// the change transfer is decomposed into at most one output per decimal digit
+const size_t CHANGE_OUTPUTS = 20;
+
+size_t estimateTransactionSize(size_t _inputs, size_t _outputs, quint64 _mixin) {
+  return TRANSACTION_PREFIX_SIZE + _inputs * (INPUT_SIZE + (_mixin + 1) * RING_MEMBER_SIZE) +
+    (_outputs + CHANGE_OUTPUTS) * OUTPUT_SIZE;
+}
+
+size_t decomposedOutputCount(quint64 _amount) {
+  size_t count = 0;
+  for (; _amount != 0; _amount /= 10) {
+    count += _amount % 10 != 0 ? 1 : 0;
+  }
+
+  return count;
+}
+
+// outputs that are not a single digit times a power of ten have no decoys to mix with
+bool isDecomposedAmount(quint64 _amount) {
+  while (_amount != 0 && _amount % 10 == 0) {
+    _amount /= 10;
+  }
+
+  return _amount < 10;
+}
+
+bool outputLess(const CryptoNote::TransactionOutputInformation* _a, const CryptoNote::TransactionOutputInformation* _b) {
+  const int order = std::memcmp(&_a->transactionHash, &_b->transactionHash, sizeof(Crypto::Hash));
+  return order != 0 ? order < 0 : _a->outputInTransaction < _b->outputInTransaction;
+}
+
+// the plan is made up front, a send from the send form or a reorganization in between may
+// spend or lock some of its inputs before its turn comes
+bool areInputsUnlocked(const std::list<CryptoNote::TransactionOutputInformation>& _inputs) {
+  const std::shared_ptr<const OutputIndex> index = WalletAdapter::instance().getOutputIndex();
+  std::vector<const CryptoNote::TransactionOutputInformation*> unlocked;
+  unlocked.reserve(index->unlocked().size());
+  for (const CryptoNote::TransactionOutputInformation& output : index->unlocked()) {
+    unlocked.push_back(&output);
+  }
+
+  std::sort(unlocked.begin(), unlocked.end(), outputLess);
+  return std::all_of(_inputs.begin(), _inputs.end(), [&unlocked](const CryptoNote::TransactionOutputInformation& _input) {
+    return std::binary_search(unlocked.begin(), unlocked.end(), &_input, outputLess);
+  });
+}
+
+bool isValidPaymentId(const QString& _paymentId) {
+  const QByteArray paymentId = QByteArray::fromHex(_paymentId.toUtf8());
+  return paymentId.size() == sizeof(Crypto::Hash) && _paymentId.toUpper() == QString::fromUtf8(paymentId.toHex().toUpper());
+}
+
+}
+
+BatchPayout& BatchPayout::instance() {
+  static BatchPayout inst;
+  return inst;
+}
+
+BatchPayout::BatchPayout() : QObject(), m_fee(0), m_mixin(0), m_next(0), m_succeeded(0), m_failed(0),
+  m_isRunning(false), m_transactionId(CryptoNote::WALLET_LEGACY_INVALID_TRANSACTION_ID) {
+  connect(&WalletAdapter::instance(), &WalletAdapter::walletSendTransactionCompletedSignal, this,
+    &BatchPayout::sendTransactionCompleted, Qt::QueuedConnection);
+}
+
+BatchPayout::~BatchPayout() {
+}
+
+bool BatchPayout::parseRecipients(const QString& _text, QVector<Recipient>& _recipients, QString& _error) {
+  _recipients.clear();
+  const QStringList lines = _text.split('\n');
+  for (int i = 0; i < lines.size(); ++i) {
+    const QString line = lines[i].trimmed();
+    if (line.isEmpty() || line.startsWith('#')) {
+      continue;
+    }
+
+    const QStringList fields = line.split(QRegularExpression("[,;\\t]"));
+    if (fields.size() < 2 || fields.size() > 3) {
+      _error = tr("Line %1: expected address, amount and an optional payment ID").arg(i + 1);
+      return false;
+    }
+
+    Recipient recipient;
+    recipient.address = fields[0].trimmed();
+    recipient.amount = CurrencyAdapter::instance().parseAmount(fields[1].trimmed());
+    recipient.paymentId = fields.size() == 3 ? fields[2].trimmed() : QString();
+    if (!CurrencyAdapter::instance().validateAddress(recipient.address)) {
+      _error = tr("Line %1: invalid recipient address").arg(i + 1);
+      return false;
+    }
+
+    if (recipient.amount == 0) {
+      _error = tr("Line %1: invalid amount").arg(i + 1);
+      return false;
+    }
+
+    if (!recipient.paymentId.isEmpty() && !isValidPaymentId(recipient.paymentId)) {
+      _error = tr("Line %1: invalid payment ID").arg(i + 1);
+      return false;
+    }
+
+    _recipients.append(recipient);
+  }
+
+  if (_recipients.isEmpty()) {
+    _error = tr("No recipients found");
+    return false;
+  }
+
+  return true;
+}
+
+bool BatchPayout::plan(const QVector<Recipient>& _recipients, quint64 _fee, quint64 _mixin, QString& _error) {
+  if (m_isRunning) {
+    _error = tr("A payout is already in progress");
+    return false;
+  }
+
+  m_transactions.clear();
+  m_fee = _fee;
+  m_mixin = _mixin;
+
+  // the payment ID belongs to the transaction, so recipients are grouped by it in file order
+  QStringList paymentIds;
+  QHash<QString, QVector<int>> groups;
+  for (int i = 0; i < _recipients.size(); ++i) {
+    if (!groups.contains(_recipients[i].paymentId)) {
+      paymentIds.append(_recipients[i].paymentId);
+    }
+    groups[_recipients[i].paymentId].append(i);
+  }
+
+  std::vector<CryptoNote::TransactionOutputInformation> outputs = WalletAdapter::instance().getOutputIndex()->unlocked();
+  if (_mixin > 0) {
+    outputs.erase(std::remove_if(outputs.begin(), outputs.end(), [](const CryptoNote::TransactionOutputInformation& _output) {
+      return !isDecomposedAmount(_output.amount);
+    }), outputs.end());
+  }
+
+  // largest first keeps the input count, and with it the size, of every transaction down
+  std::sort(outputs.begin(), outputs.end(), [](const CryptoNote::TransactionOutputInformation& _a, const CryptoNote::TransactionOutputInformation& _b) {
+    return _a.amount > _b.amount;
+  });
+
+  // with selected inputs the wallet spends exactly the transfers plus the fee, so the
+  // surplus of the inputs goes back to this wallet as an explicit change transfer
+  const std::string changeAddress = WalletAdapter::instance().getAddress().toStdString();
+  auto addTransaction = [this, &outputs, &changeAddress, _fee](PayoutTransaction& _transaction, size_t _firstInput,
+                                                              size_t _lastInput, quint64 _inputAmount) {
+    _transaction.inputs.assign(outputs.begin() + _firstInput, outputs.begin() + _lastInput);
+    _transaction.change = _inputAmount - _transaction.amount - _fee;
+    if (_transaction.change != 0) {
+      CryptoNote::WalletLegacyTransfer transfer;
+      transfer.address = changeAddress;
+      transfer.amount = static_cast<int64_t>(_transaction.change);
+      _transaction.transfers.push_back(transfer);
+    }
+
+    m_transactions.push_back(std::move(_transaction));
+  };
+
+  size_t cursor = 0;
+  for (const QString& paymentId : paymentIds) {
+    const QVector<int>& group = groups[paymentId];
+    PayoutTransaction transaction;
+    transaction.paymentId = paymentId;
+    transaction.amount = 0;
+    transaction.change = 0;
+    size_t firstInput = cursor;
+    quint64 inputAmount = 0;
+    size_t outputCount = 0;
+
+    for (int i = 0; i < group.size(); ) {
+      const Recipient& recipient = _recipients[group[i]];
+      const size_t cursorBefore = cursor;
+      const quint64 inputAmountBefore = inputAmount;
+      const quint64 needed = transaction.amount + recipient.amount + _fee;
+      while (inputAmount < needed && cursor < outputs.size()) {
+        inputAmount += outputs[cursor++].amount;
+      }
+
+      const bool funded = inputAmount >= needed;
+      const size_t recipientOutputs = decomposedOutputCount(recipient.amount);
+      if (funded && estimateTransactionSize(cursor - firstInput, outputCount + recipientOutputs, _mixin) <= PAYOUT_TRANSACTION_SIZE_TARGET) {
+        CryptoNote::WalletLegacyTransfer transfer;
+        transfer.address = recipient.address.toStdString();
+        transfer.amount = static_cast<int64_t>(recipient.amount);
+        transaction.transfers.push_back(transfer);
+        transaction.amount += recipient.amount;
+        outputCount += recipientOutputs;
+        ++i;
+        continue;
+      }
+
+      // give back the inputs taken for this recipient and retry it in a new transaction
+      cursor = cursorBefore;
+      inputAmount = inputAmountBefore;
+      if (transaction.transfers.empty()) {
+        _error = !funded ?
+          tr("Unlocked balance is insufficient for the payout") :
+          tr("Payout to %1 needs too many inputs for one transaction").arg(recipient.address);
+        m_transactions.clear();
+        return false;
+      }
+
+      addTransaction(transaction, firstInput, cursor, inputAmount);
+      transaction = PayoutTransaction();
+      transaction.paymentId = paymentId;
+      transaction.amount = 0;
+      transaction.change = 0;
+      firstInput = cursor;
+      inputAmount = 0;
+      outputCount = 0;
+    }
+
+    addTransaction(transaction, firstInput, cursor, inputAmount);
+  }
+
+  return true;
+}
+
+bool BatchPayout::start() {
+  if (m_isRunning || m_transactions.empty()) {
+    return false;
+  }
+
+  m_next = 0;
+  m_succeeded = 0;
+  m_failed = 0;
+  m_isRunning = true;
+  sendNext();
+  return true;
+}
+
+bool BatchPayout::isRunning() const {
+  return m_isRunning;
+}
+
+int BatchPayout::transactionCount() const {
+  return static_cast<int>(m_transactions.size());
+}
+
+int BatchPayout::recipientCount() const {
+  int count = 0;
+  for (const PayoutTransaction& transaction : m_transactions) {
+    count += static_cast<int>(transaction.transfers.size()) - (transaction.change != 0 ? 1 : 0);
+  }
+
+  return count;
+}
+
+quint64 BatchPayout::totalAmount() const {
+  quint64 amount = 0;
+  for (const PayoutTransaction& transaction : m_transactions) {
+    amount += transaction.amount;
+  }
+
+  return amount;
+}
+
+quint64 BatchPayout::totalFee() const {
+  return m_fee * m_transactions.size();
+}
+
+void BatchPayout::sendNext() {
+  while (m_next < m_transactions.size()) {
+    const PayoutTransaction& transaction = m_transactions[m_next];
+    if (!areInputsUnlocked(transaction.inputs)) {
+      ++m_failed;
+      ++m_next;
+      Q_EMIT payoutProgressSignal(static_cast<int>(m_next), transactionCount(), CryptoNote::WALLET_LEGACY_INVALID_TRANSACTION_ID,
+        CryptoNote::error::WalletErrorCodes::TX_TRANSFER_IMPOSSIBLE, tr("The planned inputs are no longer available"));
+      continue;
+    }
+
+    m_transactionId = WalletAdapter::instance().sendTransaction(transaction.transfers, transaction.inputs, m_fee,
+      transaction.paymentId, m_mixin);
+    if (m_transactionId != CryptoNote::WALLET_LEGACY_INVALID_TRANSACTION_ID) {
+      // the rest is sent from sendTransactionCompleted()
+      return;
+    }
+
+    ++m_failed;
+    ++m_next;
+    Q_EMIT payoutProgressSignal(static_cast<int>(m_next), transactionCount(), CryptoNote::WALLET_LEGACY_INVALID_TRANSACTION_ID,
+      CryptoNote::error::WalletErrorCodes::INTERNAL_WALLET_ERROR, tr("Failed to create transaction"));
+  }
+
+  finish();
+}
+
+void BatchPayout::finish() {
+  m_isRunning = false;
+  m_transactions.clear();
+  Q_EMIT payoutFinishedSignal(m_succeeded, m_failed);
+}
+
+void BatchPayout::sendTransactionCompleted(CryptoNote::TransactionId _transactionId, int _error, const QString& _errorText) {
+  if (!m_isRunning || _transactionId != m_transactionId) {
+    return;
+  }
+
+  m_transactionId = CryptoNote::WALLET_LEGACY_INVALID_TRANSACTION_ID;
+  if (_error) {
+    ++m_failed;
+  } else {
+    ++m_succeeded;
+  }
+
+  ++m_next;
+  Q_EMIT payoutProgressSignal(static_cast<int>(m_next), transactionCount(), _transactionId, _error, _errorText);
+  sendNext();
+}
+
+}
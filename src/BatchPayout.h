@@ -0,0 +1,79 @@
+// Copyright (c) 2016-2026 The Karbowanec developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+#include <list>
+#include <vector>
+
+#include <IWalletLegacy.h>
+
+namespace WalletGui {
+
+// Sends payouts to many recipients. Recipients are packed into as few
+// transactions as fit under the size target, inputs for all of them are
+// chosen in one pass over the unlocked outputs, and the transactions are
+// relayed one after another as the wallet completes them.
+class BatchPayout : public QObject {
+  Q_OBJECT
+  Q_DISABLE_COPY(BatchPayout)
+
+public:
+  struct Recipient {
+    QString address;
+    quint64 amount;
+    QString paymentId;
+  };
+
+  static BatchPayout& instance();
+
+  // one recipient per line: address,amount[,payment id]; empty lines and lines starting with # are skipped
+  static bool parseRecipients(const QString& _text, QVector<Recipient>& _recipients, QString& _error);
+
+  bool plan(const QVector<Recipient>& _recipients, quint64 _fee, quint64 _mixin, QString& _error);
+  bool start();
+  bool isRunning() const;
+
+  int transactionCount() const;
+  int recipientCount() const;
+  quint64 totalAmount() const;
+  quint64 totalFee() const;
+
+Q_SIGNALS:
+  void payoutProgressSignal(int _sent, int _total, CryptoNote::TransactionId _transactionId, int _error, const QString& _errorText);
+  void payoutFinishedSignal(int _succeeded, int _failed);
+
+private:
+  struct PayoutTransaction {
+    std::vector<CryptoNote::WalletLegacyTransfer> transfers;
+    std::list<CryptoNote::TransactionOutputInformation> inputs;
+    QString paymentId;
+    quint64 amount;
+    // sent back to this wallet as the last transfer when not zero
+    quint64 change;
+  };
+
+  std::vector<PayoutTransaction> m_transactions;
+  quint64 m_fee;
+  quint64 m_mixin;
+  size_t m_next;
+  int m_succeeded;
+  int m_failed;
+  bool m_isRunning;
+  // the transaction being relayed, completions of other sends are ignored
+  CryptoNote::TransactionId m_transactionId;
+
+  BatchPayout();
+  ~BatchPayout();
+
+  void sendNext();
+  void finish();
+  Q_SLOT void sendTransactionCompleted(CryptoNote::TransactionId _transactionId, int _error, const QString& _errorText);
+};
+
+}
@@ -0,0 +1,158 @@
+// Copyright (c) 2016-2026 The Karbowanec developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "CpuTopology.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <map>
+#include <string>
+#include <tuple>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace WalletGui {
+
+namespace {
+
+#ifdef __linux__
+const char SYSFS_CPU_DIR[] = "/sys/devices/system/cpu/";
+
+uint32_t readSysfsValue(const std::string& _path, uint32_t _default) {
+  std::ifstream file(_path);
+  long value = -1;
+  if (!(file >> value) || value < 0) {
+    return _default;
+  }
+
+  return static_cast<uint32_t>(value);
+}
+
+uint32_t readCpuNode(const std::string& _cpuDir) {
+  DIR* dir = opendir(_cpuDir.c_str());
+  if (dir == nullptr) {
+    return 0;
+  }
+
+  uint32_t node = 0;
+  while (dirent* entry = readdir(dir)) {
+    const std::string name = entry->d_name;
+    if (name.size() > 4 && name.compare(0, 4, "node") == 0 && std::all_of(name.begin() + 4, name.end(), ::isdigit)) {
+      node = static_cast<uint32_t>(std::stoul(name.substr(4)));
+      break;
+    }
+  }
+
+  closedir(dir);
+  return node;
+}
+#endif
+
+}
+
+bool isCpuPinningSupported() {
+#ifdef __linux__
+  return !getCpuTopology().empty();
+#else
+  return false;
+#endif
+}
+
+std::vector<LogicalCpu> getCpuTopology() {
+  std::vector<LogicalCpu> cpus;
+#ifdef __linux__
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+    return cpus;
+  }
+
+  // only CPUs the process may run on, so taskset and cgroup limits are honoured
+  for (uint32_t id = 0; id < CPU_SETSIZE; ++id) {
+    if (!CPU_ISSET(id, &allowed)) {
+      continue;
+    }
+
+    const std::string cpuDir = std::string(SYSFS_CPU_DIR) + "cpu" + std::to_string(id);
+    LogicalCpu cpu;
+    cpu.id = id;
+    cpu.core = readSysfsValue(cpuDir + "/topology/core_id", id);
+    cpu.package = readSysfsValue(cpuDir + "/topology/physical_package_id", 0);
+    cpu.node = readCpuNode(cpuDir);
+    cpu.sibling = 0;
+    cpus.push_back(cpu);
+  }
+
+  std::sort(cpus.begin(), cpus.end(), [](const LogicalCpu& _a, const LogicalCpu& _b) {
+    return std::tie(_a.package, _a.core, _a.id) < std::tie(_b.package, _b.core, _b.id);
+  });
+
+  for (size_t i = 1; i < cpus.size(); ++i) {
+    if (cpus[i].package == cpus[i - 1].package && cpus[i].core == cpus[i - 1].core) {
+      cpus[i].sibling = cpus[i - 1].sibling + 1;
+    }
+  }
+#endif
+  return cpus;
+}
+
+std::vector<LogicalCpu> getMiningCpuOrder(MiningAffinity _policy) {
+  std::vector<LogicalCpu> cpus;
+  if (_policy == MiningAffinity::NONE) {
+    return cpus;
+  }
+
+  cpus = getCpuTopology();
+  if (_policy == MiningAffinity::COMPACT) {
+    std::stable_sort(cpus.begin(), cpus.end(), [](const LogicalCpu& _a, const LogicalCpu& _b) {
+      return std::tie(_a.node, _a.sibling) < std::tie(_b.node, _b.sibling);
+    });
+    return cpus;
+  }
+
+  // physical cores first, taking them round-robin from every node so that
+  // scratchpads and memory bandwidth are shared out between the sockets
+  std::vector<LogicalCpu> ordered;
+  ordered.reserve(cpus.size());
+  std::map<uint32_t, std::map<uint32_t, std::vector<LogicalCpu>>> bySibling;
+  for (const LogicalCpu& cpu : cpus) {
+    bySibling[cpu.sibling][cpu.node].push_back(cpu);
+  }
+
+  for (auto& level : bySibling) {
+    for (size_t round = 0; ; ++round) {
+      bool any = false;
+      for (auto& node : level.second) {
+        if (round < node.second.size()) {
+          ordered.push_back(node.second[round]);
+          any = true;
+        }
+      }
+      if (!any) {
+        break;
+      }
+    }
+  }
+
+  return ordered;
+}
+
+bool pinCurrentThreadToCpu(uint32_t _cpu) {
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(_cpu, &set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+  (void)_cpu;
+  return false;
+#endif
+}
+
+}
@@ -0,0 +1,31 @@
+// Copyright (c) 2016-2026 The Karbowanec developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace WalletGui {
+
+enum class MiningAffinity : uint8_t {
+  NONE,           // leave placement to the OS scheduler
+  PHYSICAL_FIRST, // one thread per physical core, spread over NUMA nodes, then SMT siblings
+  COMPACT         // fill one NUMA node (cores, then siblings) before using the next
+};
+
+struct LogicalCpu {
+  uint32_t id;
+  uint32_t core;
+  uint32_t package;
+  uint32_t node;
+  uint32_t sibling; // 0 for the first hardware thread of a physical core
+};
+
+bool isCpuPinningSupported();
+std::vector<LogicalCpu> getCpuTopology();
+std::vector<LogicalCpu> getMiningCpuOrder(MiningAffinity _policy);
+bool pinCurrentThreadToCpu(uint32_t _cpu);
+
+}
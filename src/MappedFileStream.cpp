@@ -0,0 +1,87 @@
+// Copyright (c) 2016-2026 The Karbowanec developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "MappedFileStream.h"
+
+namespace WalletGui {
+
+void MappedFileStream::Buffer::reset(char* _begin, char* _end) {
+  setg(_begin, _begin, _end);
+}
+
+MappedFileStream::Buffer::pos_type MappedFileStream::Buffer::seekoff(off_type _off, std::ios_base::seekdir _dir, std::ios_base::openmode _which) {
+  if ((_which & std::ios_base::in) == 0) {
+    return pos_type(off_type(-1));
+  }
+
+  char* base = eback();
+  if (_dir == std::ios_base::cur) {
+    base = gptr();
+  } else if (_dir == std::ios_base::end) {
+    base = egptr();
+  }
+
+  if (_off < eback() - base || _off > egptr() - base) {
+    return pos_type(off_type(-1));
+  }
+
+  setg(eback(), base + _off, egptr());
+  return pos_type(gptr() - eback());
+}
+
+MappedFileStream::Buffer::pos_type MappedFileStream::Buffer::seekpos(pos_type _pos, std::ios_base::openmode _which) {
+  return seekoff(off_type(_pos), std::ios_base::beg, _which);
+}
+
+MappedFileStream::MappedFileStream() : m_data(nullptr), m_stream(&m_buffer) {
+  m_buffer.reset(nullptr, nullptr);
+}
+
+MappedFileStream::~MappedFileStream() {
+  close();
+}
+
+bool MappedFileStream::open(const QString& _path) {
+  close();
+  m_file.setFileName(_path);
+  if (!m_file.open(QIODevice::ReadOnly) || m_file.size() == 0) {
+    m_file.close();
+    return false;
+  }
+
+  m_data = m_file.map(0, m_file.size());
+  if (m_data == nullptr) {
+    m_file.close();
+    return false;
+  }
+
+  char* begin = reinterpret_cast<char*>(m_data);
+  m_buffer.reset(begin, begin + m_file.size());
+  m_stream.clear();
+  return true;
+}
+
+void MappedFileStream::close() {
+  if (m_data != nullptr) {
+    m_buffer.reset(nullptr, nullptr);
+    m_file.unmap(m_data);
+    m_data = nullptr;
+  }
+
+  if (m_file.isOpen()) {
+    m_file.close();
+  }
+
+  m_stream.clear();
+}
+
+bool MappedFileStream::isOpen() const {
+  return m_data != nullptr;
+}
+
+std::istream& MappedFileStream::stream() {
+  return m_stream;
+}
+
+}
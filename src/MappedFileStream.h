@@ -0,0 +1,45 @@
+// Copyright (c) 2016-2026 The Karbowanec developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <istream>
+#include <streambuf>
+
+#include <QFile>
+
+namespace WalletGui {
+
+// Read-only std::istream over a memory-mapped file. The wallet is decoded
+// straight from the page cache instead of being copied through fstream buffers.
+class MappedFileStream {
+public:
+  MappedFileStream();
+  ~MappedFileStream();
+
+  MappedFileStream(const MappedFileStream&) = delete;
+  MappedFileStream& operator=(const MappedFileStream&) = delete;
+
+  bool open(const QString& _path);
+  void close();
+  bool isOpen() const;
+  std::istream& stream();
+
+private:
+  class Buffer : public std::streambuf {
+  public:
+    void reset(char* _begin, char* _end);
+
+  protected:
+    pos_type seekoff(off_type _off, std::ios_base::seekdir _dir, std::ios_base::openmode _which) override;
+    pos_type seekpos(pos_type _pos, std::ios_base::openmode _which) override;
+  };
+
+  QFile m_file;
+  uchar* m_data;
+  Buffer m_buffer;
+  std::istream m_stream;
+};
+
+}
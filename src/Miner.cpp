@@ -18,9 +18,12 @@
 
 #include "Miner.h"
 
+#include <algorithm>
 #include <chrono>
+#include <cstring>
 #include <future>
 #include <iterator>
+#include <limits>
 #include <numeric>
 #include <sstream>
 #include <thread>
@@ -48,6 +51,8 @@
 #include "CryptoNoteCore/TransactionExtra.h"
 
 #include "CurrencyAdapter.h"
+#include "MiningBlob.h"
+#include "SystemLoad.h"
 #include "Wallet/WalletRpcServerCommandsDefinitions.h"
 
 #include "NodeAdapter.h"
@@ -62,24 +67,58 @@ using namespace CryptoNote;
 
 namespace WalletGui
 {
+  const uint32_t MINER_HASH_BATCH_SIZE = 16;
+  // a new tip makes the current template stale, refresh almost at once but coalesce bursts
+  const int MINER_CHAIN_REFRESH_DELAY = 50;
+  // pool changes only add fees, wait for the pool to settle and rebuild at most every 5 s
+  const int MINER_POOL_REFRESH_DELAY = 1000;
+  const uint64_t MINER_POOL_REFRESH_MIN_INTERVAL = 5000;
+
+  // the governor looks at load and temperature this often and moves by one thread per step upwards
+  const int MINER_THROTTLE_INTERVAL = 3000;
+  const double MINER_THROTTLE_TEMPERATURE_HYSTERESIS = 5;
+
+  uint64_t millisecondsSinceEpoch() {
+    auto now = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+  }
 
   Miner::Miner(QObject* _parent, Logging::ILogger &log) :
     QObject(_parent),
     m_logger(log, "Miner"),
     m_stop_mining(true),
-    m_template(boost::value_initialized<Block>()),
     m_template_no(0),
     m_diffic(0),
     m_pausers_count(0),
     m_threads_total(0),
+    m_affinity(MiningAffinity::NONE),
     m_starter_nonce(0),
     m_last_hr_merge_time(0),
-    m_hashes(0),
     m_do_mining(false),
     m_current_hash_rate(0),
     m_hash_rate(0),
-    m_update_block_template_interval(240),
-    m_update_merge_hr_interval(2) {
+    m_update_merge_hr_interval(2),
+    m_chain_update_pending(false),
+    m_template_stale_since(0),
+    m_last_template_time(0),
+    m_template_refreshes(0),
+    m_template_coalesced_events(0),
+    m_stale_chain_ms(0),
+    m_stale_pool_ms(0),
+    m_builder_requested(false),
+    m_builder_stop(false),
+    m_builder_generation(0),
+    m_threads_requested(0),
+    m_throttle_enabled(false),
+    m_throttle_paused(false),
+    m_throttle_max_cpu_share(100),
+    m_throttle_max_temperature(0) {
+    m_template_refresh_timer.setSingleShot(true);
+    connect(&m_template_refresh_timer, &QTimer::timeout, this, &Miner::refreshBlockTemplate);
+    m_throttle_timer.setInterval(MINER_THROTTLE_INTERVAL);
+    connect(&m_throttle_timer, &QTimer::timeout, this, &Miner::adjustThrottle);
+    connect(&NodeAdapter::instance(), &NodeAdapter::localBlockchainUpdatedSignal, this, &Miner::localBlockchainUpdated, Qt::QueuedConnection);
+    connect(&NodeAdapter::instance(), &NodeAdapter::poolChangedSignal, this, &Miner::poolChanged, Qt::QueuedConnection);
   }
   //-----------------------------------------------------------------------------------------------------
   Miner::~Miner() {
@@ -87,26 +126,66 @@ namespace WalletGui
   }
   //-----------------------------------------------------------------------------------------------------
   bool Miner::set_block_template(const Block& bl, const difficulty_type& di) {
-    std::lock_guard<decltype(m_template_lock)> lk(m_template_lock);
+    std::shared_ptr<prepared_template> tpl = prepare_block_template(bl, di);
+    if (!tpl) {
+      return false;
+    }
 
-    m_template = bl;
+    publish_block_template(tpl);
+    return true;
+  }
+  //-----------------------------------------------------------------------------------------------------
+  std::shared_ptr<Miner::prepared_template> Miner::prepare_block_template(const Block& bl, const difficulty_type& di) {
+    // all the per-template work happens here, outside m_template_lock
+    std::shared_ptr<prepared_template> tpl(new prepared_template());
+    tpl->block = bl;
+    tpl->difficulty = di;
 
-    if (m_template.majorVersion == BLOCK_MAJOR_VERSION_2 || m_template.majorVersion == BLOCK_MAJOR_VERSION_3) {
+    if (tpl->block.majorVersion == BLOCK_MAJOR_VERSION_2 || tpl->block.majorVersion == BLOCK_MAJOR_VERSION_3) {
       CryptoNote::TransactionExtraMergeMiningTag mm_tag;
       mm_tag.depth = 0;
-      if (!CryptoNote::get_aux_block_header_hash(m_template, mm_tag.merkleRoot)) {
-        return false;
+      if (!CryptoNote::get_aux_block_header_hash(tpl->block, mm_tag.merkleRoot)) {
+        return nullptr;
       }
 
-      m_template.parentBlock.baseTransaction.extra.clear();
-      if (!CryptoNote::appendMergeMiningTagToExtra(m_template.parentBlock.baseTransaction.extra, mm_tag)) {
-        return false;
+      tpl->block.parentBlock.baseTransaction.extra.clear();
+      if (!CryptoNote::appendMergeMiningTagToExtra(tpl->block.parentBlock.baseTransaction.extra, mm_tag)) {
+        return nullptr;
       }
     }
 
+    if (tpl->block.majorVersion >= BLOCK_MAJOR_VERSION_5 && !get_block_signing_keys(tpl->block, tpl->signing_keys)) {
+      return nullptr;
+    }
+
+    return tpl;
+  }
+  //-----------------------------------------------------------------------------------------------------
+  void Miner::publish_block_template(std::shared_ptr<const prepared_template> tpl) {
+    std::lock_guard<decltype(m_template_lock)> lk(m_template_lock);
+    m_template.swap(tpl);
     m_starter_nonce = Random::randomValue<uint32_t>();
-    m_diffic = di;
+    m_diffic = m_template->difficulty;
     ++m_template_no;
+  }
+  //-----------------------------------------------------------------------------------------------------
+  bool Miner::get_block_signing_keys(const Block& bl, block_signing_keys& keys) {
+    // everything but the signature itself depends only on the template and account keys
+    try {
+      Crypto::PublicKey txPublicKey = getTransactionPublicKeyFromExtra(bl.baseTransaction.extra);
+      Crypto::KeyDerivation derivation;
+      if (!Crypto::generate_key_derivation(txPublicKey, m_account.viewSecretKey, derivation)) {
+        m_logger(Logging::ERROR) << "Failed to generate_key_derivation for block signature";
+        return false;
+      }
+      Crypto::derive_secret_key(derivation, 0, m_account.spendSecretKey, keys.ephSecKey);
+      keys.ephPubKey = boost::get<KeyOutput>(bl.baseTransaction.outputs[0].target).key;
+    }
+    catch (std::exception& e) {
+      m_logger(Logging::ERROR) << "Preparing block signing keys failed: " << e.what();
+      return false;
+    }
+
     return true;
   }
 
@@ -131,17 +210,72 @@ namespace WalletGui
       return false;
     }
 
-    //pause();
+    request_block_template_async();
+    return true;
+  }
+  //-----------------------------------------------------------------------------------------------------
+  void Miner::request_block_template_async() {
+    {
+      std::lock_guard<std::mutex> lk(m_builder_lock);
+      m_builder_requested = true;
+    }
+    m_builder_cv.notify_all();
+  }
+  //-----------------------------------------------------------------------------------------------------
+  void Miner::template_builder_thread() {
+    std::unique_lock<std::mutex> lk(m_builder_lock);
+    const uint64_t generation = m_builder_generation;
+    for (;;) {
+      m_builder_cv.wait(lk, [this, generation]() {
+        return m_builder_stop || m_builder_requested || m_builder_generation != generation;
+      });
+      if (m_builder_stop || m_builder_generation != generation) {
+        break;
+      }
 
-    if (request_block_template()) {
-      //resume();
-      return true;
+      // requests arriving while a template is being built are served by the next round
+      m_builder_requested = false;
+      lk.unlock();
+      const bool built = request_block_template();
+      lk.lock();
+
+      if (!built && !m_builder_stop && m_builder_generation == generation) {
+        QMetaObject::invokeMethod(this, [this]() { stop(); }, Qt::QueuedConnection);
+      }
     }
-    else {
-      stop();
+  }
+  //-----------------------------------------------------------------------------------------------------
+  void Miner::start_template_builder() {
+    std::lock_guard<std::mutex> lk(m_builder_lock);
+    if (m_builder_thread.joinable()) {
+      return;
+    }
+
+    m_builder_stop = false;
+    m_builder_requested = false;
+    ++m_builder_generation;
+    m_builder_thread = std::thread(&Miner::template_builder_thread, this);
+    m_builder_cv.notify_all();
+  }
+  //-----------------------------------------------------------------------------------------------------
+  void Miner::stop_template_builder() {
+    {
+      std::lock_guard<std::mutex> lk(m_builder_lock);
+      m_builder_stop = true;
+    }
+    m_builder_cv.notify_all();
+
+    if (!m_builder_thread.joinable()) {
+      return;
     }
 
-    return false;
+    // the builder can't join itself; detached, it leaves its loop on m_builder_stop, or
+    // on the generation change if start_template_builder() starts a new one first
+    if (m_builder_thread.get_id() == std::this_thread::get_id()) {
+      m_builder_thread.detach();
+    } else {
+      m_builder_thread.join();
+    }
   }
   //-----------------------------------------------------------------------------------------------------
   bool Miner::request_block_template() {
@@ -149,6 +283,11 @@ namespace WalletGui
     QString formattedTime = date.toString("dd.MM.yyyy hh:mm:ss");
     qDebug() << formattedTime << "Requesting block template";
 
+    // taken before the request, a chain or pool event arriving while it runs marks the
+    // new template stale again and gets its own refresh
+    const uint64_t staleSince = m_template_stale_since.exchange(0);
+    const bool chainUpdate = m_chain_update_pending.exchange(false);
+
     Block bl = boost::value_initialized<Block>();
     CryptoNote::difficulty_type di = 0;
     uint32_t height;
@@ -162,7 +301,8 @@ namespace WalletGui
       return false;
     }
 
-    if (!set_block_template(bl, di)) {
+    std::shared_ptr<prepared_template> tpl = prepare_block_template(bl, di);
+    if (!tpl) {
       const QString errorMessage = tr("Failed to set block template");
       m_logger(Logging::ERROR) << errorMessage.toStdString();
       Q_EMIT minerMessageSignal(errorMessage);
@@ -170,19 +310,71 @@ namespace WalletGui
       return false;
     }
 
+    tpl->height = height;
+    publish_block_template(tpl);
+
+    const uint64_t now = millisecondsSinceEpoch();
+    if (staleSince != 0) {
+      (chainUpdate ? m_stale_chain_ms : m_stale_pool_ms) += now - staleSince;
+    }
+    m_last_template_time = now;
+    ++m_template_refreshes;
+
     Q_EMIT minerTemplateUpdatedSignal(height, static_cast<quint64>(di));
 
     return true;
   }
   //-----------------------------------------------------------------------------------------------------
+  void Miner::localBlockchainUpdated(quint64 _height) {
+    Q_UNUSED(_height);
+    schedule_template_refresh(true);
+  }
+  //-----------------------------------------------------------------------------------------------------
+  void Miner::poolChanged() {
+    schedule_template_refresh(false);
+  }
+  //-----------------------------------------------------------------------------------------------------
+  void Miner::schedule_template_refresh(bool chain_updated) {
+    if (!is_mining()) {
+      return;
+    }
+
+    const uint64_t now = millisecondsSinceEpoch();
+    if (m_template_stale_since == 0) {
+      m_template_stale_since = now;
+    }
+
+    int delay = MINER_CHAIN_REFRESH_DELAY;
+    if (chain_updated) {
+      m_chain_update_pending = true;
+    } else {
+      delay = MINER_POOL_REFRESH_DELAY;
+      const uint64_t sinceLastTemplate = now - m_last_template_time;
+      if (sinceLastTemplate < MINER_POOL_REFRESH_MIN_INTERVAL) {
+        delay = std::max<int>(delay, static_cast<int>(MINER_POOL_REFRESH_MIN_INTERVAL - sinceLastTemplate));
+      }
+    }
+
+    if (m_template_refresh_timer.isActive()) {
+      ++m_template_coalesced_events;
+      if (m_template_refresh_timer.remainingTime() <= delay) {
+        return;
+      }
+    }
+
+    m_template_refresh_timer.start(delay);
+  }
+  //-----------------------------------------------------------------------------------------------------
+  void Miner::refreshBlockTemplate() {
+    on_block_chain_update();
+  }
+  //-----------------------------------------------------------------------------------------------------
+  Miner::template_stats Miner::get_template_stats() const {
+    return {m_template_refreshes.load(), m_template_coalesced_events.load(), m_stale_chain_ms.load(), m_stale_pool_ms.load()};
+  }
+  //-----------------------------------------------------------------------------------------------------
   bool Miner::on_idle()
   {
-    m_update_block_template_interval.call([&](){
-      if (is_mining())
-        request_block_template();
-      return true;
-    });
-
     m_update_merge_hr_interval.call([&](){
       merge_hr();
       return true;
@@ -190,26 +382,28 @@ namespace WalletGui
 
     return true;
   }
-  //-----------------------------------------------------------------------------------------------------
-  uint64_t millisecondsSinceEpoch() {
-    auto now = std::chrono::steady_clock::now();
-    return std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
-  }
-
   //-----------------------------------------------------------------------------------------------------
   void Miner::merge_hr()
   {
     const uint64_t now = millisecondsSinceEpoch();
-    const uint64_t hashes = m_hashes.exchange(0);
+    const uint64_t interval = now - m_last_hr_merge_time + 1;
+    uint64_t hashes = 0;
+    {
+      // counters only grow, so reading them never writes to a worker's cache line
+      std::lock_guard<std::mutex> threadsLock(m_threads_lock);
+      for (auto& miningThread : m_threads) {
+        const uint64_t threadHashes = miningThread.hashes->hashes.load(std::memory_order_relaxed);
+        const uint64_t delta = threadHashes - miningThread.last_hashes;
+        miningThread.last_hashes = threadHashes;
+        miningThread.hash_rate = m_last_hr_merge_time ? delta * 1000 / interval : 0;
+        hashes += delta;
+      }
+    }
+
     if(m_last_hr_merge_time && is_mining()) {
-      m_current_hash_rate = hashes * 1000 / (now - m_last_hr_merge_time + 1);
-      std::lock_guard<std::mutex> lk(m_last_hash_rates_lock);
-      m_last_hash_rates.push_back(m_current_hash_rate);
-      if(m_last_hash_rates.size() > 19)
-        m_last_hash_rates.pop_front();
-
-      uint64_t total_hr = std::accumulate(m_last_hash_rates.begin(), m_last_hash_rates.end(), static_cast<uint64_t>(0));
-      m_hash_rate = static_cast<float>(total_hr) / static_cast<float>(m_last_hash_rates.size());
+      m_current_hash_rate = hashes * 1000 / interval;
+      m_last_hash_rates.push(m_current_hash_rate);
+      m_hash_rate = m_last_hash_rates.average();
       //qDebug() << "Hashrate: " << m_hash_rate << " H/s";
     }
     
@@ -253,15 +447,18 @@ namespace WalletGui
     }
 
     m_threads_total = static_cast<uint32_t>(threads_count);
+    m_threads_requested = static_cast<uint32_t>(threads_count);
     reset_nonce_sequence();
-    m_hashes = 0;
     m_current_hash_rate = 0;
     m_hash_rate = 0;
     m_last_hr_merge_time = millisecondsSinceEpoch();
-    {
-      std::lock_guard<std::mutex> hashRatesLock(m_last_hash_rates_lock);
-      m_last_hash_rates.clear();
-    }
+    m_last_hash_rates.clear();
+    m_template_stale_since = 0;
+    m_chain_update_pending = false;
+    m_template_refreshes = 0;
+    m_template_coalesced_events = 0;
+    m_stale_chain_ms = 0;
+    m_stale_pool_ms = 0;
 
     // always request block template on start
     if (!request_block_template()) {
@@ -270,11 +467,17 @@ namespace WalletGui
     }
 
     m_stop_mining = false;
+    start_template_builder();
+    m_throttle_paused = false;
+    m_load_sampler.reset();
+    if (m_throttle_enabled) {
+      m_throttle_timer.start();
+    }
     m_pausers_count = 0; // in case mining wasn't resumed after pause
+    m_cpu_order = getMiningCpuOrder(m_affinity);
 
     for (uint32_t i = 0; i != threads_count; i++) {
-      std::shared_ptr<std::atomic<bool>> stopSignal(new std::atomic<bool>(false));
-      m_threads.emplace_back(i, stopSignal, std::thread(std::bind(&Miner::worker_thread, this, i, stopSignal)));
+      add_worker_thread(i);
     }
 
     QDateTime date = QDateTime::currentDateTime();
@@ -296,11 +499,21 @@ namespace WalletGui
       threads_count = 1;
     }
 
+    m_threads_requested = static_cast<uint32_t>(threads_count);
     if (!is_mining()) {
       m_threads_total = static_cast<uint32_t>(threads_count);
       return true;
     }
 
+    if (m_throttle_enabled) {
+      // the governor owns the active count, it only follows the new ceiling
+      return m_threads_total <= threads_count || resize_workers(threads_count);
+    }
+
+    return resize_workers(threads_count);
+  }
+  //-----------------------------------------------------------------------------------------------------
+  bool Miner::resize_workers(size_t threads_count) {
     std::list<MiningThread> threadsToJoin;
     uint32_t oldThreadsCount = 0;
 
@@ -315,8 +528,7 @@ namespace WalletGui
 
       if (threads_count > oldThreadsCount) {
         for (uint32_t i = oldThreadsCount; i != threads_count; ++i) {
-          std::shared_ptr<std::atomic<bool>> stopSignal(new std::atomic<bool>(false));
-          m_threads.emplace_back(i, stopSignal, std::thread(std::bind(&Miner::worker_thread, this, i, stopSignal)));
+          add_worker_thread(i);
         }
       } else {
         while (m_threads.size() > threads_count) {
@@ -341,6 +553,32 @@ namespace WalletGui
     return true;
   }
   
+  //-----------------------------------------------------------------------------------------------------
+  void Miner::add_worker_thread(uint32_t th_local_index) {
+    std::shared_ptr<std::atomic<bool>> stopSignal(new std::atomic<bool>(false));
+    std::shared_ptr<hash_counter> hashes(new hash_counter());
+    const int32_t cpu = m_cpu_order.empty() ? -1 : static_cast<int32_t>(m_cpu_order[th_local_index % m_cpu_order.size()].id);
+    m_threads.emplace_back(th_local_index, cpu, stopSignal, hashes,
+                           std::thread(std::bind(&Miner::worker_thread, this, th_local_index, cpu, stopSignal, hashes)));
+  }
+
+  //-----------------------------------------------------------------------------------------------------
+  bool Miner::set_affinity_policy(MiningAffinity policy) {
+    std::lock_guard<std::mutex> lk(m_threads_lock);
+    if (!m_threads.empty()) {
+      // placement is decided when the threads are spawned
+      return false;
+    }
+
+    m_affinity = policy;
+    return true;
+  }
+
+  //-----------------------------------------------------------------------------------------------------
+  MiningAffinity Miner::get_affinity_policy() const {
+    return m_affinity;
+  }
+
   //-----------------------------------------------------------------------------------------------------
   double Miner::get_speed()
   {
@@ -349,6 +587,28 @@ namespace WalletGui
     else
       return 0;
   }
+
+  //-----------------------------------------------------------------------------------------------------
+  double Miner::get_current_speed()
+  {
+    if(is_mining())
+      return static_cast<double>(m_current_hash_rate.load());
+    else
+      return 0;
+  }
+
+  //-----------------------------------------------------------------------------------------------------
+  std::vector<Miner::thread_hash_rate> Miner::get_thread_speeds()
+  {
+    std::vector<thread_hash_rate> speeds;
+    std::lock_guard<std::mutex> lk(m_threads_lock);
+    speeds.reserve(m_threads.size());
+    for (const auto& miningThread : m_threads) {
+      speeds.push_back({miningThread.index, miningThread.cpu, miningThread.hash_rate});
+    }
+
+    return speeds;
+  }
   
   //-----------------------------------------------------------------------------------------------------
   void Miner::send_stop_signal() 
@@ -360,6 +620,9 @@ namespace WalletGui
   bool Miner::stop()
   {
     const bool wasMining = !m_stop_mining.exchange(true);
+    m_template_refresh_timer.stop();
+    m_throttle_timer.stop();
+    stop_template_builder();
     int threadsCount = 0;
     std::list<MiningThread> threadsToJoin;
 
@@ -381,14 +644,10 @@ namespace WalletGui
       }
     }
 
-    m_hashes = 0;
     m_current_hash_rate = 0;
     m_hash_rate = 0;
     m_last_hr_merge_time = 0;
-    {
-      std::lock_guard<std::mutex> hashRatesLock(m_last_hash_rates_lock);
-      m_last_hash_rates.clear();
-    }
+    m_last_hash_rates.clear();
 
     if (!wasMining && threadsCount == 0) {
       return true;
@@ -431,14 +690,110 @@ namespace WalletGui
       //Q_EMIT minerMessageSignal(QString("MINING RESUMED"));
   }
   //-----------------------------------------------------------------------------------------------------
-  bool Miner::worker_thread(uint32_t th_local_index, std::shared_ptr<std::atomic<bool>> _thread_stop)
+  void Miner::set_adaptive_throttle(bool enabled, uint32_t max_cpu_share, uint32_t max_temperature) {
+    m_throttle_max_cpu_share = std::max<uint32_t>(1, std::min<uint32_t>(max_cpu_share, 100));
+    m_throttle_max_temperature = max_temperature;
+    if (m_throttle_enabled == enabled) {
+      return;
+    }
+
+    m_throttle_enabled = enabled;
+    if (!is_mining()) {
+      return;
+    }
+
+    if (enabled) {
+      m_load_sampler.reset();
+      m_throttle_timer.start();
+      return;
+    }
+
+    // hand the full requested thread count back
+    m_throttle_timer.stop();
+    if (m_throttle_paused) {
+      m_throttle_paused = false;
+      resume();
+    }
+    resize_workers(m_threads_requested);
+    Q_EMIT minerThrottleSignal(m_threads_total.load(), m_threads_requested, -1, -1, false);
+  }
+  //-----------------------------------------------------------------------------------------------------
+  void Miner::adjustThrottle() {
+    if (!is_mining()) {
+      return;
+    }
+
+    const uint32_t requested = std::max<uint32_t>(1, m_threads_requested);
+    const uint32_t active = m_throttle_paused ? 0 : m_threads_total.load();
+    uint32_t allowed = requested;
+
+    double systemBusy = 0;
+    double minerBusy = 0;
+    double load = -1;
+    if (m_load_sampler.sample(systemBusy, minerBusy)) {
+      // what other processes use is theirs, mining gets the rest of the CPU share target
+      const double cpus = std::max(1u, std::thread::hardware_concurrency());
+      const double otherBusy = std::max(0.0, systemBusy - minerBusy);
+      const double room = cpus * m_throttle_max_cpu_share / 100 - otherBusy;
+      allowed = std::min<uint32_t>(requested, static_cast<uint32_t>(std::max(0.0, room)));
+      load = systemBusy / cpus * 100;
+    }
+
+    const double temperature = readCpuTemperature();
+    if (temperature >= 0 && m_throttle_max_temperature != 0) {
+      if (temperature >= m_throttle_max_temperature) {
+        allowed = std::min<uint32_t>(allowed, active > 0 ? active - 1 : 0);
+      } else if (temperature > m_throttle_max_temperature - MINER_THROTTLE_TEMPERATURE_HYSTERESIS) {
+        allowed = std::min(allowed, active);
+      }
+    }
+
+    // back off at once but grow one thread per step, our own load needs a sample to show
+    allowed = std::min(allowed, active + 1);
+
+    if (allowed == 0) {
+      // keep one worker parked rather than tearing everything down
+      if (!m_throttle_paused) {
+        m_throttle_paused = true;
+        resize_workers(1);
+        pause();
+      }
+    } else {
+      if (m_throttle_paused) {
+        m_throttle_paused = false;
+        resume();
+      }
+      if (allowed != m_threads_total.load()) {
+        resize_workers(allowed);
+      }
+    }
+
+    Q_EMIT minerThrottleSignal(allowed, requested, load, temperature, m_throttle_paused);
+  }
+  //-----------------------------------------------------------------------------------------------------
+  bool Miner::worker_thread(uint32_t th_local_index, int32_t th_cpu, std::shared_ptr<std::atomic<bool>> _thread_stop,
+                            std::shared_ptr<hash_counter> _thread_hashes)
   {
     m_logger(Logging::DEBUGGING) << "Miner thread was started ["<< th_local_index << "]";
+
+    // pin before anything is allocated so the hashing memory is first touched on the local node
+    if (th_cpu >= 0) {
+      if (pinCurrentThreadToCpu(static_cast<uint32_t>(th_cpu))) {
+        m_logger(Logging::DEBUGGING) << "Miner thread [" << th_local_index << "] pinned to CPU " << th_cpu;
+      } else {
+        m_logger(Logging::WARNING) << "Failed to pin miner thread [" << th_local_index << "] to CPU " << th_cpu;
+      }
+    }
+
     uint32_t nonce = m_starter_nonce.load() + th_local_index;
     difficulty_type local_diff = 0;
     uint32_t local_template_ver = 0;
     Crypto::cn_context context;
     Block b;
+    block_signing_keys signing_keys;
+    BinaryArray hashing_blob;
+    size_t nonce_offset = 0;
+    NodeAdapter& node = NodeAdapter::instance();
 
     while(!m_stop_mining.load() && !_thread_stop->load())
     {
@@ -450,11 +805,31 @@ namespace WalletGui
 
       const uint32_t observed_template_ver = m_template_no.load();
       if(local_template_ver != observed_template_ver) {
-        std::unique_lock<std::mutex> lk(m_template_lock);
-        b = m_template;
-        local_diff = m_diffic;
-        local_template_ver = m_template_no.load();
-        nonce = m_starter_nonce.load() + th_local_index;
+        std::shared_ptr<const prepared_template> tpl;
+        {
+          // only the pointer is taken under the lock, the copy is made outside
+          std::lock_guard<std::mutex> lk(m_template_lock);
+          tpl = m_template;
+          local_template_ver = m_template_no.load();
+          nonce = m_starter_nonce.load() + th_local_index;
+        }
+
+        if (tpl) {
+          b = tpl->block;
+          local_diff = tpl->difficulty;
+          signing_keys = tpl->signing_keys;
+        }
+
+        // serialize the hashing blob once per template, only the nonce is patched below
+        if (local_template_ver && b.majorVersion >= CryptoNote::BLOCK_MAJOR_VERSION_5 &&
+            !get_hashing_blob_with_nonce_offset(b, hashing_blob, nonce_offset)) {
+          m_logger(Logging::ERROR) << "get_block_hashing_blob for signature failed.";
+          const QString errorMessage = QStringLiteral("get_block_hashing_blob for signature failed");
+          Q_EMIT minerMessageSignal(errorMessage);
+          Q_EMIT miningErrorSignal(errorMessage);
+          m_stop_mining = true;
+          break;
+        }
       }
 
       if(!local_template_ver) //no any set_block_template call
@@ -464,95 +839,75 @@ namespace WalletGui
         continue;
       }
 
-      b.nonce = nonce;
+      uint32_t hashes_done = 0;
+      for (; hashes_done < MINER_HASH_BATCH_SIZE && !m_stop_mining.load(); ++hashes_done)
+      {
+        if (hashes_done != 0 && local_template_ver != m_template_no.load()) {
+          break;
+        }
 
-      // step 1: sing the block
-      if (b.majorVersion >= CryptoNote::BLOCK_MAJOR_VERSION_5) {
-        BinaryArray ba;
-        if (!get_block_hashing_blob(b, ba)) {
-          m_logger(Logging::ERROR) << "get_block_hashing_blob for signature failed.";
-          const QString errorMessage = QStringLiteral("get_block_hashing_blob for signature failed");
-          Q_EMIT minerMessageSignal(errorMessage);
-          Q_EMIT miningErrorSignal(errorMessage);
-          m_stop_mining = true;
+        b.nonce = nonce;
+
+        // step 1: sing the block
+        if (b.majorVersion >= CryptoNote::BLOCK_MAJOR_VERSION_5) {
+          memcpy(hashing_blob.data() + nonce_offset, &nonce, sizeof(nonce));
+          Crypto::Hash h = Crypto::cn_fast_hash(hashing_blob.data(), hashing_blob.size());
+          Crypto::generate_signature(h, signing_keys.ephPubKey, signing_keys.ephSecKey, b.signature);
         }
 
-        Crypto::Hash h = Crypto::cn_fast_hash(ba.data(), ba.size());
-        try {
-          Crypto::PublicKey txPublicKey = getTransactionPublicKeyFromExtra(b.baseTransaction.extra);
-          Crypto::KeyDerivation derivation;
-          if (!Crypto::generate_key_derivation(txPublicKey, m_account.viewSecretKey, derivation)) {
-            m_logger(Logging::ERROR) << "Failed to generate_key_derivation for block signature";
-            const QString errorMessage = QStringLiteral("Failed to generate_key_derivation for block signature");
+        // step 2: get long hash
+        Crypto::Hash pow;
+
+        if (!m_stop_mining.load()) {
+          if (!node.getBlockLongHash(context, b, pow)) {
+            m_logger(Logging::ERROR) << "getBlockLongHash failed.";
+            const QString errorMessage = tr("getBlockLongHash failed");
             Q_EMIT minerMessageSignal(errorMessage);
             Q_EMIT miningErrorSignal(errorMessage);
             m_stop_mining = true;
           }
-          Crypto::SecretKey ephSecKey;
-          Crypto::derive_secret_key(derivation, 0, m_account.spendSecretKey, ephSecKey);
-          Crypto::PublicKey ephPubKey = boost::get<KeyOutput>(b.baseTransaction.outputs[0].target).key;
-
-          Crypto::generate_signature(h, ephPubKey, ephSecKey, b.signature);
         }
-        catch (std::exception& e) {
-          m_logger(Logging::ERROR) << "Signing block failed: " << e.what();
-          const QString errorMessage = QString(tr("Signing block failed")) + QString(e.what());
-          Q_EMIT minerMessageSignal(errorMessage);
-          Q_EMIT miningErrorSignal(errorMessage);
-          m_stop_mining = true;
-        }
-      }
 
-      // step 2: get long hash
-      Crypto::Hash pow;
+        if (!m_stop_mining.load() && check_hash(pow, local_diff))
+        {
+          // we lucky!
 
-      if (!m_stop_mining.load()) {
-        if (!NodeAdapter::instance().getBlockLongHash(context, b, pow)) {
-          m_logger(Logging::ERROR) << "getBlockLongHash failed.";
-          const QString errorMessage = tr("getBlockLongHash failed");
-          Q_EMIT minerMessageSignal(errorMessage);
-          Q_EMIT miningErrorSignal(errorMessage);
-          m_stop_mining = true;
-        }
-      }
-
-      if (!m_stop_mining.load() && check_hash(pow, local_diff))
-      {
-        // we lucky!
+          //pause();
 
-        //pause();
-
-        Crypto::Hash id;
-        if (!get_block_hash(b, id)) {
-          m_logger(Logging::ERROR) << "Failed to get block hash.";
-          const QString errorMessage = QStringLiteral("Failed to get block hash");
-          Q_EMIT minerMessageSignal(errorMessage);
-          Q_EMIT miningErrorSignal(errorMessage);
-          m_stop_mining = true;
-        }
-        uint32_t bh = boost::get<BaseInput>(b.baseTransaction.inputs[0]).blockIndex;
+          Crypto::Hash id;
+          if (!get_block_hash(b, id)) {
+            m_logger(Logging::ERROR) << "Failed to get block hash.";
+            const QString errorMessage = QStringLiteral("Failed to get block hash");
+            Q_EMIT minerMessageSignal(errorMessage);
+            Q_EMIT miningErrorSignal(errorMessage);
+            m_stop_mining = true;
+          }
+          uint32_t bh = boost::get<BaseInput>(b.baseTransaction.inputs[0]).blockIndex;
 
-        QDateTime date = QDateTime::currentDateTime();
-        QString formattedTime = date.toString("dd.MM.yyyy hh:mm:ss");
+          QDateTime date = QDateTime::currentDateTime();
+          QString formattedTime = date.toString("dd.MM.yyyy hh:mm:ss");
 
-        const QString blockHash = QString::fromStdString(Common::podToHex(id));
-        const QString powHash = QString::fromStdString(Common::podToHex(pow));
-        m_logger(Logging::INFO) << "Found block " << Common::podToHex(id) << " at height " << bh << " for difficulty: " << local_diff << ", POW " << Common::podToHex(pow);
-        Q_EMIT minerMessageSignal(QString(tr("%1 Found block %2 at height %3 for difficulty %4, POW %5")).arg(formattedTime).arg(blockHash).arg(bh).arg(local_diff).arg(powHash));
-        Q_EMIT blockFoundSignal(blockHash, bh, static_cast<quint64>(local_diff), powHash);
+          const QString blockHash = QString::fromStdString(Common::podToHex(id));
+          const QString powHash = QString::fromStdString(Common::podToHex(pow));
+          m_logger(Logging::INFO) << "Found block " << Common::podToHex(id) << " at height " << bh << " for difficulty: " << local_diff << ", POW " << Common::podToHex(pow);
+          Q_EMIT minerMessageSignal(QString(tr("%1 Found block %2 at height %3 for difficulty %4, POW %5")).arg(formattedTime).arg(blockHash).arg(bh).arg(local_diff).arg(powHash));
+          Q_EMIT blockFoundSignal(blockHash, bh, static_cast<quint64>(local_diff), powHash);
 
-        if(!NodeAdapter::instance().handleBlockFound(b)) {
-          m_logger(Logging::ERROR) << "Failed to submit block to the main chain";
-          const QString errorMessage = tr("Failed to submit block to the main chain");
-          Q_EMIT minerMessageSignal(errorMessage);
-          Q_EMIT miningErrorSignal(errorMessage);
-        } else {
-          // yay!
+          if(!node.handleBlockFound(b)) {
+            m_logger(Logging::ERROR) << "Failed to submit block to the main chain";
+            const QString errorMessage = tr("Failed to submit block to the main chain");
+            Q_EMIT minerMessageSignal(errorMessage);
+            Q_EMIT miningErrorSignal(errorMessage);
+          } else {
+            // yay!
+          }
         }
+
+        nonce += m_threads_total.load();
       }
 
-      nonce += m_threads_total.load();
-      ++m_hashes;
+      // this thread is the only writer, a plain store avoids a locked add
+      _thread_hashes->hashes.store(_thread_hashes->hashes.load(std::memory_order_relaxed) + hashes_done, std::memory_order_relaxed);
     }
     m_logger(Logging::DEBUGGING) << "Miner thread stopped ["<< th_local_index << "]";
     return true;
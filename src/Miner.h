@@ -21,8 +21,12 @@
 #include <QObject>
 #include <QReadWriteLock>
 #include <QString>
+#include <QTimer>
 
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <condition_variable>
 #include <list>
 #include <memory>
 #include <mutex>
@@ -34,6 +38,8 @@
 #include "CryptoNoteCore/OnceInInterval.h"
 #include "Logging/LoggerRef.h"
 #include "Serialization/ISerializer.h"
+#include "CpuTopology.h"
+#include "SystemLoad.h"
 #include "WalletAdapter.h"
 
 using namespace CryptoNote;
@@ -43,6 +49,19 @@ namespace WalletGui {
     Q_OBJECT
 
   public:
+    struct thread_hash_rate {
+      uint32_t index;
+      int32_t cpu; // -1 when the thread is not pinned
+      uint64_t hash_rate;
+    };
+
+    struct template_stats {
+      uint64_t refreshes;
+      uint64_t coalesced_events;
+      uint64_t stale_chain_ms; // tip moved, workers were hashing on an outdated parent
+      uint64_t stale_pool_ms;  // pool changed, template was missing newer transactions
+    };
+
     Miner(QObject* _parent, Logging::ILogger& log);
     ~Miner();
 
@@ -52,6 +71,12 @@ namespace WalletGui {
     bool start(size_t threads_count);
     bool set_thread_count(size_t threads_count);
     double get_speed();
+    double get_current_speed();
+    std::vector<thread_hash_rate> get_thread_speeds();
+    bool set_affinity_policy(MiningAffinity policy);
+    MiningAffinity get_affinity_policy() const;
+    template_stats get_template_stats() const;
+    void set_adaptive_throttle(bool enabled, uint32_t max_cpu_share, uint32_t max_temperature);
     void send_stop_signal();
     bool stop();
     bool is_mining();
@@ -62,16 +87,90 @@ namespace WalletGui {
     void merge_hr();
 
   private:
-    bool worker_thread(uint32_t th_local_index, std::shared_ptr<std::atomic<bool>> _thread_stop);
+    static const size_t HASH_RATE_SAMPLES = 19;
+
+    // written by its worker only and padded to a cache line, so workers never share one
+    struct alignas(64) hash_counter {
+      std::atomic<uint64_t> hashes{0};
+    };
+
+    // fixed-size hashrate history, one producer (merge_hr) and lock-free readers
+    class hash_rate_ring {
+    public:
+      hash_rate_ring() : m_pushed(0) {
+        clear();
+      }
+
+      void push(uint64_t sample) {
+        const uint64_t slot = m_pushed.load(std::memory_order_relaxed);
+        m_samples[slot % m_samples.size()].store(sample, std::memory_order_relaxed);
+        m_pushed.store(slot + 1, std::memory_order_release);
+      }
+
+      void clear() {
+        m_pushed.store(0, std::memory_order_relaxed);
+        for (auto& sample : m_samples) {
+          sample.store(0, std::memory_order_relaxed);
+        }
+      }
+
+      double average() const {
+        const uint64_t count = std::min<uint64_t>(m_pushed.load(std::memory_order_acquire), m_samples.size());
+        if (count == 0) {
+          return 0;
+        }
+
+        uint64_t total = 0;
+        for (uint64_t i = 0; i < count; ++i) {
+          total += m_samples[i].load(std::memory_order_relaxed);
+        }
+        return static_cast<double>(total) / static_cast<double>(count);
+      }
+
+    private:
+      std::array<std::atomic<uint64_t>, HASH_RATE_SAMPLES> m_samples;
+      std::atomic<uint64_t> m_pushed;
+    };
+
+    struct block_signing_keys {
+      Crypto::PublicKey ephPubKey;
+      Crypto::SecretKey ephSecKey;
+    };
+
+    // a template with all per-template work done, published to the workers by a pointer swap
+    struct prepared_template {
+      Block block;
+      difficulty_type difficulty = 0;
+      uint32_t height = 0;
+      block_signing_keys signing_keys;
+    };
+
+    bool worker_thread(uint32_t th_local_index, int32_t th_cpu, std::shared_ptr<std::atomic<bool>> _thread_stop,
+                       std::shared_ptr<hash_counter> _thread_hashes);
+    void add_worker_thread(uint32_t th_local_index);
+    bool resize_workers(size_t threads_count);
     void reset_nonce_sequence();
+    void schedule_template_refresh(bool chain_updated);
+    std::shared_ptr<prepared_template> prepare_block_template(const Block& bl, const difficulty_type& diffic);
+    void publish_block_template(std::shared_ptr<const prepared_template> tpl);
+    void request_block_template_async();
+    void template_builder_thread();
+    void start_template_builder();
+    void stop_template_builder();
+    bool get_block_signing_keys(const Block& bl, block_signing_keys& keys);
 
     struct MiningThread {
-      MiningThread(uint32_t _index, std::shared_ptr<std::atomic<bool>> _stop_signal, std::thread&& _thread) :
-          index(_index), stop_signal(std::move(_stop_signal)), thread(std::move(_thread)) {
+      MiningThread(uint32_t _index, int32_t _cpu, std::shared_ptr<std::atomic<bool>> _stop_signal,
+                   std::shared_ptr<hash_counter> _hashes, std::thread&& _thread) :
+          index(_index), cpu(_cpu), stop_signal(std::move(_stop_signal)), hashes(std::move(_hashes)), thread(std::move(_thread)) {
       }
 
       uint32_t index;
+      int32_t cpu;
       std::shared_ptr<std::atomic<bool>> stop_signal;
+      std::shared_ptr<hash_counter> hashes;
+      uint64_t last_hashes = 0;
+      uint64_t hash_rate = 0;
       std::thread thread;
     };
 
@@ -85,7 +184,7 @@ namespace WalletGui {
 
     std::atomic<bool> m_stop_mining;
     std::mutex m_template_lock;
-    Block m_template;
+    std::shared_ptr<const prepared_template> m_template;
     std::atomic<uint32_t> m_template_no;
     std::atomic<uint32_t> m_starter_nonce;
     difficulty_type m_diffic;
@@ -96,23 +195,53 @@ namespace WalletGui {
 
     std::list<MiningThread> m_threads;
     std::mutex m_threads_lock;
+    MiningAffinity m_affinity;
+    std::vector<LogicalCpu> m_cpu_order;
     AccountKeys m_account;
-    OnceInInterval m_update_block_template_interval;
     OnceInInterval m_update_merge_hr_interval;
 
+    QTimer m_template_refresh_timer;
+    std::atomic<bool> m_chain_update_pending;
+    std::atomic<uint64_t> m_template_stale_since;
+    std::atomic<uint64_t> m_last_template_time;
+    std::atomic<uint64_t> m_template_refreshes;
+    std::atomic<uint64_t> m_template_coalesced_events;
+    std::atomic<uint64_t> m_stale_chain_ms;
+    std::atomic<uint64_t> m_stale_pool_ms;
+
+    std::thread m_builder_thread;
+    std::mutex m_builder_lock;
+    std::condition_variable m_builder_cv;
+    bool m_builder_requested;
+    bool m_builder_stop;
+    // bumped on every start, a detached builder from an earlier start sees it and exits
+    uint64_t m_builder_generation;
+
+    // adaptive throttle, GUI thread only
+    QTimer m_throttle_timer;
+    CpuLoadSampler m_load_sampler;
+    uint32_t m_threads_requested;
+    bool m_throttle_enabled;
+    bool m_throttle_paused;
+    uint32_t m_throttle_max_cpu_share;
+    uint32_t m_throttle_max_temperature;
+
     std::vector<BinaryArray> m_extra_messages;
     miner_config m_config;
     std::string m_config_folder_path;
     std::atomic<uint64_t> m_last_hr_merge_time;
-    std::atomic<uint64_t> m_hashes;
     std::atomic<uint64_t> m_current_hash_rate;
     std::atomic<double> m_hash_rate;
-    std::mutex m_last_hash_rates_lock;
-    std::list<uint64_t> m_last_hash_rates;
+    hash_rate_ring m_last_hash_rates;
     bool m_do_mining;
 
     Logging::LoggerRef m_logger;
 
+    Q_SLOT void localBlockchainUpdated(quint64 _height);
+    Q_SLOT void poolChanged();
+    Q_SLOT void refreshBlockTemplate();
+    Q_SLOT void adjustThrottle();
+
   Q_SIGNALS:
     void minerMessageSignal(const QString& _message);
     void minerStartedSignal(quint32 _threads, quint64 _difficulty);
@@ -121,6 +250,8 @@ namespace WalletGui {
     void minerTemplateUpdatedSignal(quint64 _height, quint64 _difficulty);
     void blockFoundSignal(const QString& _hash, quint64 _height, quint64 _difficulty, const QString& _pow);
     void miningErrorSignal(const QString& _message);
+    // _load and _temperature are negative when unknown
+    void minerThrottleSignal(quint32 _activeThreads, quint32 _maxThreads, double _load, double _temperature, bool _paused);
 
   };
 }
@@ -0,0 +1,38 @@
+// Copyright (c) 2016-2026 The Karbowanec developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "MiningBlob.h"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+#include "CryptoNoteCore/CryptoNoteFormatUtils.h"
+
+namespace WalletGui {
+
+bool get_hashing_blob_with_nonce_offset(const CryptoNote::Block& bl, CryptoNote::BinaryArray& blob, size_t& nonce_offset) {
+  // the header is serialized twice with complementary nonces, the only
+  // bytes that differ are the nonce bytes we patch on every hash
+  CryptoNote::Block probe = bl;
+  CryptoNote::BinaryArray inverted;
+  probe.nonce = 0;
+  if (!CryptoNote::get_block_hashing_blob(probe, blob)) {
+    return false;
+  }
+  probe.nonce = std::numeric_limits<uint32_t>::max();
+  if (!CryptoNote::get_block_hashing_blob(probe, inverted) || inverted.size() != blob.size()) {
+    return false;
+  }
+
+  auto diff = std::mismatch(blob.begin(), blob.end(), inverted.begin());
+  if (diff.first == blob.end()) {
+    return false;
+  }
+
+  nonce_offset = static_cast<size_t>(std::distance(blob.begin(), diff.first));
+  return nonce_offset + sizeof(probe.nonce) <= blob.size();
+}
+
+}
@@ -0,0 +1,17 @@
+// Copyright (c) 2016-2026 The Karbowanec developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <cstddef>
+
+#include "CryptoNoteCore/CryptoNoteBasic.h"
+
+namespace WalletGui {
+
+// Serializes the hashing blob of a block and finds where its nonce lives,
+// so a miner can patch the nonce in place instead of re-serializing.
+bool get_hashing_blob_with_nonce_offset(const CryptoNote::Block& bl, CryptoNote::BinaryArray& blob, size_t& nonce_offset);
+
+}
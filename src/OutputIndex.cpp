@@ -0,0 +1,85 @@
+// Copyright (c) 2016-2026 The Karbowanec developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "OutputIndex.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace WalletGui {
+
+bool OutputIndex::OutputKey::operator<(const OutputKey& _other) const {
+  const int cmp = std::memcmp(&transactionHash, &_other.transactionHash, sizeof(transactionHash));
+  return cmp < 0 || (cmp == 0 && outputInTransaction < _other.outputInTransaction);
+}
+
+bool OutputIndex::OutputKey::operator==(const OutputKey& _other) const {
+  return outputInTransaction == _other.outputInTransaction &&
+    std::memcmp(&transactionHash, &_other.transactionHash, sizeof(transactionHash)) == 0;
+}
+
+OutputIndex::OutputKey OutputIndex::outputKey(const CryptoNote::TransactionOutputInformation& _output) {
+  return OutputKey{_output.transactionHash, _output.outputInTransaction};
+}
+
+OutputIndex::OutputIndex() : m_unspent(std::make_shared<const std::vector<CryptoNote::TransactionOutputInformation>>()),
+  m_spent(std::make_shared<const std::vector<CryptoNote::TransactionSpentOutputInformation>>()),
+  m_unlockedAmount(0), m_lockedAmount(0), m_spentAmount(0) {
+}
+
+OutputIndex::OutputIndex(std::vector<CryptoNote::TransactionOutputInformation>&& _unspent,
+  std::vector<CryptoNote::TransactionOutputInformation>&& _locked,
+  std::vector<CryptoNote::TransactionSpentOutputInformation>&& _spent) :
+  m_unspent(std::make_shared<const std::vector<CryptoNote::TransactionOutputInformation>>(std::move(_unspent))),
+  m_locked(std::move(_locked)),
+  m_spent(std::make_shared<const std::vector<CryptoNote::TransactionSpentOutputInformation>>(std::move(_spent))),
+  m_unlockedAmount(0), m_lockedAmount(0), m_spentAmount(0) {
+  splitUnlocked();
+  for (const CryptoNote::TransactionSpentOutputInformation& output : *m_spent) {
+    m_spentAmount += output.amount;
+  }
+}
+
+OutputIndex::OutputIndex(const OutputIndex& _previous, std::vector<CryptoNote::TransactionOutputInformation>&& _locked) :
+  m_unspent(_previous.m_unspent), m_locked(std::move(_locked)), m_spent(_previous.m_spent),
+  m_unlockedAmount(0), m_lockedAmount(0), m_spentAmount(_previous.m_spentAmount) {
+  splitUnlocked();
+}
+
+bool OutputIndex::hasLocked(const std::vector<CryptoNote::TransactionOutputInformation>& _locked) const {
+  if (_locked.size() != m_lockedKeys.size()) {
+    return false;
+  }
+
+  std::vector<OutputKey> keys;
+  keys.reserve(_locked.size());
+  for (const CryptoNote::TransactionOutputInformation& output : _locked) {
+    keys.push_back(outputKey(output));
+  }
+
+  std::sort(keys.begin(), keys.end());
+  return keys == m_lockedKeys;
+}
+
+void OutputIndex::splitUnlocked() {
+  m_lockedKeys.reserve(m_locked.size());
+  for (const CryptoNote::TransactionOutputInformation& output : m_locked) {
+    m_lockedKeys.push_back(outputKey(output));
+    m_lockedAmount += output.amount;
+  }
+
+  std::sort(m_lockedKeys.begin(), m_lockedKeys.end());
+  m_unlocked.reserve(m_unspent->size());
+  for (const CryptoNote::TransactionOutputInformation& output : *m_unspent) {
+    if (std::binary_search(m_lockedKeys.begin(), m_lockedKeys.end(), outputKey(output))) {
+      continue;
+    }
+
+    m_unlocked.push_back(output);
+    m_unlockedAmount += output.amount;
+    ++m_unlockedAmounts[output.amount];
+  }
+}
+
+}
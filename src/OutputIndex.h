@@ -0,0 +1,70 @@
+// Copyright (c) 2016-2026 The Karbowanec developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "ITransfersContainer.h"
+
+namespace WalletGui {
+
+// Immutable snapshot of the wallet outputs, split into the sets the GUI asks
+// for, with a histogram of the unlocked amounts and running totals. Built
+// once per change of the wallet and shared by const reference afterwards.
+class OutputIndex {
+public:
+  OutputIndex();
+  OutputIndex(std::vector<CryptoNote::TransactionOutputInformation>&& _unspent,
+    std::vector<CryptoNote::TransactionOutputInformation>&& _locked,
+    std::vector<CryptoNote::TransactionSpentOutputInformation>&& _spent);
+  // same unspent and spent outputs as _previous, which are shared rather than copied,
+  // split again by a new locked set
+  OutputIndex(const OutputIndex& _previous, std::vector<CryptoNote::TransactionOutputInformation>&& _locked);
+
+  // whether _locked holds the same outputs as locked(), in any order
+  bool hasLocked(const std::vector<CryptoNote::TransactionOutputInformation>& _locked) const;
+
+  // everything IWalletLegacy::getOutputs() reports
+  const std::vector<CryptoNote::TransactionOutputInformation>& unspent() const { return *m_unspent; }
+  // unspent outputs that are not locked
+  const std::vector<CryptoNote::TransactionOutputInformation>& unlocked() const { return m_unlocked; }
+  const std::vector<CryptoNote::TransactionOutputInformation>& locked() const { return m_locked; }
+  const std::vector<CryptoNote::TransactionSpentOutputInformation>& spent() const { return *m_spent; }
+
+  // number of unlocked outputs of every amount
+  const std::map<uint64_t, size_t>& unlockedAmounts() const { return m_unlockedAmounts; }
+  uint64_t unlockedAmount() const { return m_unlockedAmount; }
+  uint64_t lockedAmount() const { return m_lockedAmount; }
+  uint64_t spentAmount() const { return m_spentAmount; }
+
+private:
+  struct OutputKey {
+    Crypto::Hash transactionHash;
+    uint32_t outputInTransaction;
+
+    bool operator<(const OutputKey& _other) const;
+    bool operator==(const OutputKey& _other) const;
+  };
+
+  std::shared_ptr<const std::vector<CryptoNote::TransactionOutputInformation>> m_unspent;
+  std::vector<CryptoNote::TransactionOutputInformation> m_unlocked;
+  std::vector<CryptoNote::TransactionOutputInformation> m_locked;
+  // sorted, for the unlocked split and hasLocked()
+  std::vector<OutputKey> m_lockedKeys;
+  std::shared_ptr<const std::vector<CryptoNote::TransactionSpentOutputInformation>> m_spent;
+  std::map<uint64_t, size_t> m_unlockedAmounts;
+  uint64_t m_unlockedAmount;
+  uint64_t m_lockedAmount;
+  uint64_t m_spentAmount;
+
+  static OutputKey outputKey(const CryptoNote::TransactionOutputInformation& _output);
+  void splitUnlocked();
+};
+
+}
@@ -313,6 +313,22 @@ quint16 Settings::getMiningThreads() const {
   }
 }
 
+quint8 Settings::getMiningAffinity() const {
+  return m_settings.contains("miningAffinity") ? m_settings.value("miningAffinity").toInt() : 0;
+}
+
+bool Settings::isMiningThrottleEnabled() const {
+  return m_settings.contains("miningThrottle") ? m_settings.value("miningThrottle").toBool() : false;
+}
+
+quint8 Settings::getMiningMaxCpuShare() const {
+  return m_settings.contains("miningMaxCpuShare") ? m_settings.value("miningMaxCpuShare").toInt() : 75;
+}
+
+quint8 Settings::getMiningMaxTemperature() const {
+  return m_settings.contains("miningMaxTemperature") ? m_settings.value("miningMaxTemperature").toInt() : 80;
+}
+
 bool Settings::isMiningOnLaunchEnabled() const {
   return m_settings.contains("autostartMininig") ? m_settings.value("autostartMininig").toBool() : false;
 }
@@ -604,6 +620,34 @@ void Settings::setMiningThreads(const quint16& _threads) {
   saveSettings();
 }
 
+void Settings::setMiningAffinity(const quint8& _affinity) {
+  if (getMiningAffinity() != _affinity) {
+    m_settings.insert("miningAffinity", _affinity);
+    saveSettings();
+  }
+}
+
+void Settings::setMiningThrottleEnabled(bool _enable) {
+  if (isMiningThrottleEnabled() != _enable) {
+    m_settings.insert("miningThrottle", _enable);
+    saveSettings();
+  }
+}
+
+void Settings::setMiningMaxCpuShare(const quint8& _percent) {
+  if (getMiningMaxCpuShare() != _percent) {
+    m_settings.insert("miningMaxCpuShare", _percent);
+    saveSettings();
+  }
+}
+
+void Settings::setMiningMaxTemperature(const quint8& _celsius) {
+  if (getMiningMaxTemperature() != _celsius) {
+    m_settings.insert("miningMaxTemperature", _celsius);
+    saveSettings();
+  }
+}
+
 #ifdef Q_OS_WIN
 void Settings::setMinimizeToTrayEnabled(bool _enable) {
   if (isMinimizeToTrayEnabled() != _enable) {
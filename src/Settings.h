@@ -64,6 +64,10 @@ public:
   quint16 getCurrentLocalDaemonPort() const;
   NodeSetting getCurrentRemoteNode() const;
   quint16 getMiningThreads() const;
+  quint8 getMiningAffinity() const;
+  bool isMiningThrottleEnabled() const;
+  quint8 getMiningMaxCpuShare() const;
+  quint8 getMiningMaxTemperature() const;
   QString getCurrentTheme() const;
 
   quint32 getRollBack() const;
@@ -98,6 +102,10 @@ public:
   void setCurrentRemoteNode(const NodeSetting &remoteNode);
   void setRpcNodesList(const QVector<NodeSetting> &RpcNodesList);
   void setMiningThreads(const quint16& _threads);
+  void setMiningAffinity(const quint8& _affinity);
+  void setMiningThrottleEnabled(bool _enable);
+  void setMiningMaxCpuShare(const quint8& _percent);
+  void setMiningMaxTemperature(const quint8& _celsius);
 #ifdef Q_OS_WIN
   void setMinimizeToTrayEnabled(bool _enable);
   void setCloseToTrayEnabled(bool _enable);
@@ -0,0 +1,89 @@
+// Copyright (c) 2016-2026 The Karbowanec developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "SyncProgressEstimator.h"
+
+namespace WalletGui {
+
+namespace {
+
+const std::chrono::milliseconds SAMPLE_INTERVAL(1000);
+const std::chrono::milliseconds REPORT_INTERVAL(500);
+const std::chrono::milliseconds LOG_INTERVAL(30000);
+// weight of the newest window rate, about the last five samples dominate
+const double RATE_SMOOTHING = 0.3;
+
+}
+
+SyncProgressEstimator::SyncProgressEstimator() {
+  reset();
+}
+
+void SyncProgressEstimator::reset() {
+  m_first = 0;
+  m_count = 0;
+  m_rate = 0.0;
+  m_progress = SyncProgress{0, 0, 0.0, -1};
+  m_lastReport = Clock::time_point();
+  m_lastLog = Clock::time_point();
+  m_reported = false;
+}
+
+bool SyncProgressEstimator::update(uint32_t _current, uint32_t _total, Clock::time_point _now) {
+  const Sample* newest = m_count == 0 ? nullptr : &m_samples[(m_first + m_count - 1) % RING_SIZE];
+  if (newest != nullptr && _current < newest->height) {
+    // the synchronizer went back, e.g. after a reorganization
+    m_first = 0;
+    m_count = 0;
+    m_rate = 0.0;
+    newest = nullptr;
+  }
+
+  if (newest == nullptr || _now - newest->time >= SAMPLE_INTERVAL) {
+    if (m_count == RING_SIZE) {
+      m_first = (m_first + 1) % RING_SIZE;
+      --m_count;
+    }
+
+    m_samples[(m_first + m_count) % RING_SIZE] = Sample{_now, _current};
+    ++m_count;
+
+    if (m_count > 1) {
+      const Sample& oldest = m_samples[m_first];
+      const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(_now - oldest.time).count();
+      const double windowRate = elapsed > 0 ? static_cast<double>(_current - oldest.height) * 1000.0 / elapsed : 0.0;
+      m_rate = m_count == 2 ? windowRate : RATE_SMOOTHING * windowRate + (1.0 - RATE_SMOOTHING) * m_rate;
+    }
+  }
+
+  m_progress.current = _current;
+  m_progress.total = _total;
+  m_progress.blocksPerSecond = m_rate;
+  if (_total <= _current) {
+    m_progress.etaSeconds = 0;
+  } else if (m_rate > 0.0) {
+    m_progress.etaSeconds = static_cast<int64_t>((_total - _current) / m_rate);
+  } else {
+    m_progress.etaSeconds = -1;
+  }
+
+  if (m_reported && _now - m_lastReport < REPORT_INTERVAL) {
+    return false;
+  }
+
+  m_reported = true;
+  m_lastReport = _now;
+  return true;
+}
+
+bool SyncProgressEstimator::isLogDue(Clock::time_point _now) {
+  if (m_lastLog != Clock::time_point() && _now - m_lastLog < LOG_INTERVAL) {
+    return false;
+  }
+
+  m_lastLog = _now;
+  return true;
+}
+
+}
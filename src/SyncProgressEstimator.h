@@ -0,0 +1,59 @@
+// Copyright (c) 2016-2026 The Karbowanec developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace WalletGui {
+
+struct SyncProgress {
+  uint32_t current;
+  uint32_t total;
+  // zero until two samples at least a sample interval apart were taken
+  double blocksPerSecond;
+  // negative while the rate is unknown
+  int64_t etaSeconds;
+};
+
+// Estimates the synchronization rate from the observer progress callbacks.
+// Heights are sampled at most once per sample interval into a fixed ring,
+// the rate over the ring is smoothed with an exponentially weighted average
+// and reports are throttled, so a callback per block costs no allocation.
+class SyncProgressEstimator {
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  SyncProgressEstimator();
+
+  void reset();
+  // true when a progress report is due
+  bool update(uint32_t _current, uint32_t _total, Clock::time_point _now = Clock::now());
+  // true at most once per log interval
+  bool isLogDue(Clock::time_point _now = Clock::now());
+
+  const SyncProgress& progress() const { return m_progress; }
+
+private:
+  struct Sample {
+    Clock::time_point time;
+    uint32_t height;
+  };
+
+  static const size_t RING_SIZE = 16;
+
+  std::array<Sample, RING_SIZE> m_samples;
+  size_t m_first;
+  size_t m_count;
+  double m_rate;
+  SyncProgress m_progress;
+  Clock::time_point m_lastReport;
+  Clock::time_point m_lastLog;
+  bool m_reported;
+};
+
+}
@@ -0,0 +1,213 @@
+// Copyright (c) 2016-2026 The Karbowanec developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "SystemLoad.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#ifdef __linux__
+#include <dirent.h>
+#endif
+
+namespace WalletGui {
+
+namespace {
+
+#ifdef __linux__
+bool readSystemTimes(uint64_t& _total, uint64_t& _idle, uint32_t& _cpus) {
+  std::ifstream stat("/proc/stat");
+  std::string line;
+  _cpus = 0;
+  bool found = false;
+  while (std::getline(stat, line)) {
+    if (line.compare(0, 3, "cpu") != 0) {
+      break;
+    }
+
+    if (line.size() > 3 && std::isdigit(static_cast<unsigned char>(line[3]))) {
+      ++_cpus;
+      continue;
+    }
+
+    // user nice system idle iowait irq softirq steal, guest time is already in user
+    std::istringstream fields(line.substr(3));
+    uint64_t value = 0;
+    _total = 0;
+    _idle = 0;
+    for (int i = 0; i < 8 && fields >> value; ++i) {
+      _total += value;
+      if (i == 3 || i == 4) {
+        _idle += value;
+      }
+    }
+    found = true;
+  }
+
+  return found && _cpus != 0;
+}
+
+bool readProcessTime(uint64_t& _ticks) {
+  std::ifstream stat("/proc/self/stat");
+  std::string line;
+  if (!std::getline(stat, line)) {
+    return false;
+  }
+
+  // the command name may contain spaces, fields are counted from its closing bracket
+  const size_t nameEnd = line.rfind(')');
+  if (nameEnd == std::string::npos) {
+    return false;
+  }
+
+  std::istringstream fields(line.substr(nameEnd + 1));
+  std::string field;
+  for (int i = 3; i < 14 && fields >> field; ++i) {
+  }
+
+  uint64_t utime = 0;
+  uint64_t stime = 0;
+  if (!(fields >> utime >> stime)) {
+    return false;
+  }
+
+  _ticks = utime + stime;
+  return true;
+}
+#endif
+
+}
+
+CpuLoadSampler::CpuLoadSampler() : m_total(0), m_idle(0), m_process(0), m_valid(false) {
+}
+
+void CpuLoadSampler::reset() {
+  m_valid = false;
+}
+
+bool CpuLoadSampler::sample(double& _systemBusy, double& _processBusy) {
+#ifdef __linux__
+  uint64_t total = 0;
+  uint64_t idle = 0;
+  uint64_t process = 0;
+  uint32_t cpus = 0;
+  if (!readSystemTimes(total, idle, cpus) || !readProcessTime(process)) {
+    m_valid = false;
+    return false;
+  }
+
+  const bool hadSample = m_valid && total > m_total;
+  const uint64_t totalDelta = total - m_total;
+  const uint64_t idleDelta = idle - m_idle;
+  const uint64_t processDelta = process - m_process;
+  m_total = total;
+  m_idle = idle;
+  m_process = process;
+  m_valid = true;
+  if (!hadSample) {
+    return false;
+  }
+
+  // /proc/stat sums every CPU, so a fraction of it times the CPU count is CPUs busy
+  _systemBusy = static_cast<double>(totalDelta - idleDelta) / totalDelta * cpus;
+  _processBusy = static_cast<double>(processDelta) / totalDelta * cpus;
+  return true;
+#else
+  (void)_systemBusy;
+  (void)_processBusy;
+  return false;
+#endif
+}
+
+#ifdef __linux__
+namespace {
+
+std::string readFirstLine(const std::string& _path) {
+  std::ifstream file(_path);
+  std::string line;
+  std::getline(file, line);
+  return line;
+}
+
+void readMilliCelsius(const std::string& _path, double& _hottest) {
+  std::ifstream file(_path);
+  long milliCelsius = 0;
+  if (file >> milliCelsius && milliCelsius > 0) {
+    _hottest = std::max(_hottest, milliCelsius / 1000.0);
+  }
+}
+
+// calls _visit(entry name) for every entry of _dir whose name starts with _prefix
+template<typename Visit>
+void forEachEntry(const std::string& _dir, const std::string& _prefix, Visit _visit) {
+  DIR* dir = opendir(_dir.c_str());
+  if (dir == nullptr) {
+    return;
+  }
+
+  while (dirent* entry = readdir(dir)) {
+    const std::string name = entry->d_name;
+    if (name.compare(0, _prefix.size(), _prefix) == 0) {
+      _visit(name);
+    }
+  }
+
+  closedir(dir);
+}
+
+// package sensors of Intel CPUs and the CPU zones of ARM SoCs; battery, wifi, GPU,
+// chipset and similar zones would report something other than the miner's load
+bool isCpuThermalZone(const std::string& _type) {
+  return _type == "x86_pkg_temp" || _type.compare(0, 3, "cpu") == 0 || _type.compare(0, 3, "soc") == 0;
+}
+
+// AMD CPUs and most desktops expose their CPU only through hwmon
+bool isCpuHwmon(const std::string& _name) {
+  return _name == "coretemp" || _name == "k10temp" || _name == "zenpower" || _name == "cpu_thermal";
+}
+
+}
+#endif
+
+double readCpuTemperature() {
+  double hottest = -1;
+#ifdef __linux__
+  const std::string thermalDir = "/sys/class/thermal/";
+  forEachEntry(thermalDir, "thermal_zone", [&](const std::string& _zone) {
+    if (isCpuThermalZone(readFirstLine(thermalDir + _zone + "/type"))) {
+      readMilliCelsius(thermalDir + _zone + "/temp", hottest);
+    }
+  });
+
+  if (hottest < 0) {
+    const std::string hwmonDir = "/sys/class/hwmon/";
+    forEachEntry(hwmonDir, "hwmon", [&](const std::string& _hwmon) {
+      if (!isCpuHwmon(readFirstLine(hwmonDir + _hwmon + "/name"))) {
+        return;
+      }
+
+      forEachEntry(hwmonDir + _hwmon, "temp", [&](const std::string& _sensor) {
+        if (_sensor.size() > 6 && _sensor.compare(_sensor.size() - 6, 6, "_input") == 0) {
+          readMilliCelsius(hwmonDir + _hwmon + "/" + _sensor, hottest);
+        }
+      });
+    });
+  }
+
+  // the ACPI zone is usually near the CPU, used only when nothing better is there
+  if (hottest < 0) {
+    forEachEntry(thermalDir, "thermal_zone", [&](const std::string& _zone) {
+      if (readFirstLine(thermalDir + _zone + "/type") == "acpitz") {
+        readMilliCelsius(thermalDir + _zone + "/temp", hottest);
+      }
+    });
+  }
+#endif
+  return hottest;
+}
+
+}
@@ -0,0 +1,31 @@
+// Copyright (c) 2016-2026 The Karbowanec developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <cstdint>
+
+namespace WalletGui {
+
+// Samples CPU time from /proc between consecutive calls. Busy time is
+// reported in logical CPUs, e.g. 2.5 means two and a half CPUs were busy.
+class CpuLoadSampler {
+public:
+  CpuLoadSampler();
+
+  // false on the first call and where /proc is not available
+  bool sample(double& _systemBusy, double& _processBusy);
+  void reset();
+
+private:
+  uint64_t m_total;
+  uint64_t m_idle;
+  uint64_t m_process;
+  bool m_valid;
+};
+
+// Hottest CPU sensor in degrees Celsius, negative when no sensor is exposed.
+double readCpuTemperature();
+
+}
@@ -12,6 +12,7 @@
 #include <QLocale>
 #include <QVector>
 #include <QDebug>
+#include <QSaveFile>
 
 #include <boost/filesystem.hpp>
 
@@ -48,6 +49,13 @@ const quint32 MSECS_IN_MINUTE = 60 * 1000;
 
 const quint32 LAST_BLOCK_INFO_UPDATING_INTERVAL = 1 * MSECS_IN_MINUTE;
 const quint32 LAST_BLOCK_INFO_WARNING_INTERVAL = 1 * MSECS_IN_HOUR;
+// routine saves after sending are coalesced, a full save rewrites the whole cache
+const quint32 WALLET_SAVE_COALESCE_INTERVAL = 10 * 1000;
+// progress callbacks arrive per block, the GUI gets at most this many updates a second
+const quint32 SYNC_PROGRESS_FLUSHES_PER_SECOND = 10;
+// a sync checkpoint is a full save with cache, taken after this many blocks or this much time
+const quint64 SYNC_CHECKPOINT_BLOCKS = 10000;
+const qint64 SYNC_CHECKPOINT_INTERVAL = 5 * MSECS_IN_MINUTE;
 
 WalletAdapter& WalletAdapter::instance() {
   static WalletAdapter inst;
@@ -55,8 +63,15 @@ WalletAdapter& WalletAdapter::instance() {
 }
 
 WalletAdapter::WalletAdapter() : QObject(), m_wallet(nullptr), m_mutex(), m_isBackupInProgress(false),
-  m_syncSpeed(0), m_syncPeriod(0), m_isSynchronized(false), m_newTransactionsNotificationTimer(),
+  m_isSynchronized(false), m_newTransactionsNotificationTimer(),
   m_lastWalletTransactionId(std::numeric_limits<quint64>::max()),
+  m_changeCount(0), m_savedChangeCount(0), m_isSaveInProgress(false),
+  m_savingChangeCount(0), m_isFullSave(false), m_isSavePending(false),
+  m_pendingSaveDetails(false), m_pendingSaveCache(false),
+  m_syncProgressCurrent(0), m_syncProgressTotal(0), m_isSyncProgressPending(false), m_droppedSyncProgress(0),
+  m_isSyncProgressQueued(false),
+  m_outputIndexWallet(nullptr), m_isOutputIndexStale(true), m_isLockedOutputsStale(false),
+  m_checkpointHeight(0), m_isCheckpointSave(false),
   m_logger(LoggerAdapter::instance().getLoggerManager(), "WalletAdapter")
 {
   connect(this, &WalletAdapter::walletInitCompletedSignal, this, &WalletAdapter::onWalletInitCompleted, Qt::QueuedConnection);
@@ -71,12 +86,22 @@ WalletAdapter::WalletAdapter() : QObject(), m_wallet(nullptr), m_mutex(), m_isBa
   }, Qt::QueuedConnection);
 
   connect(this, &WalletAdapter::walletSynchronizationCompletedSignal, this, [&]() {
+    m_checkpointTimer.invalidate();
     m_newTransactionsNotificationTimer.stop();
     notifyAboutLastTransaction();
   }, Qt::QueuedConnection);
 
   m_newTransactionsNotificationTimer.setInterval(500);
 
+  m_saveTimer.setSingleShot(true);
+  m_saveTimer.setInterval(WALLET_SAVE_COALESCE_INTERVAL);
+  connect(&m_saveTimer, &QTimer::timeout, this, &WalletAdapter::saveIfChanged);
+  connect(this, &WalletAdapter::walletSaveCompletedSignal, this, &WalletAdapter::onWalletSaveCompleted, Qt::QueuedConnection);
+
+  m_syncProgressTimer.setSingleShot(true);
+  connect(&m_syncProgressTimer, &QTimer::timeout, this, &WalletAdapter::flushSyncProgress);
+  connect(this, &WalletAdapter::flushSyncProgressSignal, this, &WalletAdapter::flushSyncProgress, Qt::QueuedConnection);
+
   // init wallet rpc config
   bool no = false;
   std::string dummy = "";
@@ -147,11 +172,12 @@ void WalletAdapter::open(const QString& _password) {
     }
 
     if (Settings::instance().getWalletFile().endsWith(".wallet")) {
-      if (openFile(Settings::instance().getWalletFile(), true)) {
+      if (openMappedFile(Settings::instance().getWalletFile())) {
         try {
-          m_wallet->initAndLoad(m_file, _password.toStdString());
+          // the loader runs asynchronously, the mapping is released in initCompleted()
+          m_wallet->initAndLoad(m_mappedFile.stream(), _password.toStdString());
         } catch (std::system_error&) {
-          closeFile();
+          closeMappedFile();
           delete m_wallet;
           m_wallet = nullptr;
         }
@@ -166,19 +192,18 @@ void WalletAdapter::open(const QString& _password) {
 bool WalletAdapter::tryOpen(const QString& _password) {
   Q_ASSERT(m_wallet != nullptr);
   if (Settings::instance().getWalletFile().endsWith(".wallet")) {
-    if (openFile(Settings::instance().getWalletFile(), true)) {
+    // a mapping held open while the saver thread commits would keep QSaveFile from
+    // renaming over the file on Windows; saves only start on this thread, so none
+    // begins before the mapping is closed again
+    waitForSave();
+    if (openMappedFile(Settings::instance().getWalletFile())) {
       try {
-        if (m_wallet->tryLoadWallet(m_file, _password.toStdString())) {
-          closeFile();
-          return true;
-        }
-        else {
-          closeFile();
-          return false;
-        }
+        const bool loaded = m_wallet->tryLoadWallet(m_mappedFile.stream(), _password.toStdString());
+        closeMappedFile();
+        return loaded;
       }
       catch (std::system_error&) {
-        closeFile();
+        closeMappedFile();
         return false;
       }
     }
@@ -270,7 +295,10 @@ bool WalletAdapter::importLegacyWallet(const QString &_password) {
 
 void WalletAdapter::close() {
   Q_CHECK_PTR(m_wallet);
+  finishPendingBackups();
+  m_isSavePending = false;
   save(true, true);
+  waitForSave();
   lock();
   m_wallet->removeObserver(this);
   m_isSynchronized = false;
@@ -287,46 +315,144 @@ void WalletAdapter::close() {
 }
 
 bool WalletAdapter::save(bool _details, bool _cache) {
-  return save(Settings::instance().getWalletFile() + ".temp", _details, _cache);
+  m_saveTimer.stop();
+  if (m_isSaveInProgress) {
+    // the running save may have missed the latest changes, write again when it's done
+    m_isSavePending = true;
+    m_pendingSaveDetails = m_pendingSaveDetails || _details;
+    m_pendingSaveCache = m_pendingSaveCache || _cache;
+    return true;
+  }
+
+  return startSave(Settings::instance().getWalletFile(), _details, _cache, false);
+}
+
+void WalletAdapter::scheduleSave() {
+  if (!m_saveTimer.isActive()) {
+    m_saveTimer.start();
+  }
+}
+
+void WalletAdapter::saveIfChanged() {
+  if (m_wallet == nullptr || m_changeCount == m_savedChangeCount) {
+    return;
+  }
+
+  // a save or a backup is still being written, try again later
+  if (m_isSaveInProgress) {
+    m_saveTimer.start();
+    return;
+  }
+
+  save(true, true);
 }
 
-bool WalletAdapter::save(const QString& _file, bool _details, bool _cache) {
+bool WalletAdapter::startSave(const QString& _file, bool _details, bool _cache, bool _backup) {
   Q_CHECK_PTR(m_wallet);
-  if (openFile(_file, false)) {
+  {
+    QMutexLocker locker(&m_saveMutex);
+    m_isSaveInProgress = true;
+  }
+
+  // the wallet serializes into memory, the file is written in saveCompleted()
+  m_saveFile = _file;
+  m_isBackupInProgress = _backup;
+  // read before the snapshot, a change made meanwhile only causes one more save
+  m_savingChangeCount = m_changeCount;
+  m_isFullSave = _details && _cache && !_backup;
+  m_saveBuffer.str(std::string());
+  m_saveBuffer.clear();
+  if (!m_isCheckpointSave) {
     Q_EMIT walletStateChangedSignal(tr("Saving data"));
-    try {
-      m_wallet->save(m_file, _details, _cache);
-    } catch (std::system_error&) {
-      closeFile();
-      return false;
-    }
-  } else {
+  }
+
+  try {
+    m_wallet->save(m_saveBuffer, _details, _cache);
+  } catch (std::system_error&) {
+    finishSave();
     return false;
   }
 
   return true;
 }
 
-void WalletAdapter::backup(const QString& _file) {
-  if (save(_file.endsWith(".wallet") ? _file : _file + ".wallet", true, false)) {
-    m_isBackupInProgress = true;
+void WalletAdapter::finishSave() {
+  m_saveBuffer.str(std::string());
+  m_isBackupInProgress = false;
+  QMutexLocker locker(&m_saveMutex);
+  m_isSaveInProgress = false;
+  m_saveFinished.wakeAll();
+}
+
+void WalletAdapter::waitForSave() {
+  QMutexLocker locker(&m_saveMutex);
+  while (m_isSaveInProgress) {
+    m_saveFinished.wait(&m_saveMutex);
   }
 }
 
+void WalletAdapter::finishPendingBackups() {
+  // only used while closing, when the GUI may wait for the disk
+  waitForSave();
+  while (!m_pendingBackups.isEmpty()) {
+    startSave(m_pendingBackups.takeFirst(), true, false, true);
+    waitForSave();
+  }
+}
+
+bool WalletAdapter::writeWalletFile(const QString& _file, std::streambuf& _data) {
+  // QSaveFile writes next to the target, syncs it to disk and renames it over the old file
+  QSaveFile file(_file);
+  if (!file.open(QIODevice::WriteOnly)) {
+    return false;
+  }
+
+  // copied out in chunks, the serialized wallet is never duplicated in memory
+  std::vector<char> chunk(64 * 1024);
+  std::streamsize read;
+  while ((read = _data.sgetn(chunk.data(), static_cast<std::streamsize>(chunk.size()))) > 0) {
+    if (file.write(chunk.data(), static_cast<qint64>(read)) != static_cast<qint64>(read)) {
+      file.cancelWriting();
+      return false;
+    }
+  }
+
+  return file.commit();
+}
+
+void WalletAdapter::startBackup(const QString& _file) {
+  // a backup waits for the running save instead of blocking the GUI, see onWalletSaveCompleted()
+  if (m_isSaveInProgress) {
+    if (!m_pendingBackups.contains(_file)) {
+      m_pendingBackups.append(_file);
+    }
+
+    return;
+  }
+
+  startSave(_file, true, false, true);
+}
+
+void WalletAdapter::backup(const QString& _file) {
+  startBackup(_file.endsWith(".wallet") ? _file : _file + ".wallet");
+}
+
 void WalletAdapter::autoBackup(){
   QString source = Settings::instance().getWalletFile();
   source.append(QString(".backup"));
 
   if (!source.isEmpty() && !QFile::exists(source)) {
-    if (save(source, true, false)) {
-      m_isBackupInProgress = true;
-    }
+    startBackup(source);
   }
 }
 
 void WalletAdapter::reset() {
   Q_CHECK_PTR(m_wallet);
+  m_saveTimer.stop();
+  finishPendingBackups();
+  m_isSavePending = false;
   save(false, false);
+  waitForSave();
   lock();
   m_wallet->removeObserver(this);
   m_isSynchronized = false;
@@ -400,55 +526,57 @@ Crypto::SecretKey WalletAdapter::getTxKey(Crypto::Hash& txid) {
   return CryptoNote::NULL_SECRET_KEY;
 }
 
-std::vector<CryptoNote::TransactionOutputInformation> WalletAdapter::getOutputs() {
+std::shared_ptr<const OutputIndex> WalletAdapter::getOutputIndex() {
   Q_CHECK_PTR(m_wallet);
-  try {
-    return m_wallet->getOutputs();
-  } catch (std::system_error&) {
-  }
-  return {};
-}
+  QMutexLocker locker(&m_outputIndexMutex);
+  // both flags are cleared before reading, so a change reported meanwhile is picked up next time
+  const bool isLockedStale = m_isLockedOutputsStale.exchange(false);
+  if (m_isOutputIndexStale.exchange(false) || !m_outputIndex || m_outputIndexWallet != m_wallet) {
+    try {
+      m_outputIndex = std::make_shared<const OutputIndex>(m_wallet->getOutputs(), m_wallet->getLockedOutputs(),
+        m_wallet->getSpentOutputs());
+      m_outputIndexWallet = m_wallet;
+    } catch (std::system_error&) {
+      m_outputIndex = std::make_shared<const OutputIndex>();
+      m_outputIndexWallet = nullptr;
+    }
 
-std::vector<CryptoNote::TransactionOutputInformation> WalletAdapter::getLockedOutputs() {
-  Q_CHECK_PTR(m_wallet);
-  try {
-    return m_wallet->getLockedOutputs();
-  } catch (std::system_error&) {
+    return m_outputIndex;
   }
-  return {};
-}
 
-std::vector<CryptoNote::TransactionOutputInformation> WalletAdapter::getUnlockedOutputs() {
-  Q_CHECK_PTR(m_wallet);
-  try {
-    return m_wallet->getLockedOutputs();
-  } catch (std::system_error&) {
+  if (!isLockedStale) {
+    return m_outputIndex;
   }
-  return {};
-}
 
-std::vector<CryptoNote::TransactionSpentOutputInformation> WalletAdapter::getSpentOutputs() {
-  Q_CHECK_PTR(m_wallet);
+  // a balance update on a new block only moves outputs from locked to unlocked,
+  // the unspent and spent sets are shared with the previous snapshot
   try {
-    return m_wallet->getSpentOutputs();
+    std::vector<CryptoNote::TransactionOutputInformation> locked = m_wallet->getLockedOutputs();
+    if (!m_outputIndex->hasLocked(locked)) {
+      m_outputIndex = std::make_shared<const OutputIndex>(*m_outputIndex, std::move(locked));
+    }
   } catch (std::system_error&) {
+    m_isOutputIndexStale = true;
   }
-  return {};
+
+  return m_outputIndex;
 }
 
-void WalletAdapter::sendTransaction(const std::vector<CryptoNote::WalletLegacyTransfer>& _transfers, quint64 _fee, const QString& _payment_id, quint64 _mixin) {
+CryptoNote::TransactionId WalletAdapter::sendTransaction(const std::vector<CryptoNote::WalletLegacyTransfer>& _transfers, quint64 _fee, const QString& _payment_id, quint64 _mixin) {
   Q_CHECK_PTR(m_wallet);
   try {
     lock();
     Q_EMIT walletStateChangedSignal(tr("Sending transaction"));
-    m_wallet->sendTransaction(_transfers, _fee, NodeAdapter::instance().convertPaymentId(_payment_id), _mixin, 0);
+    return m_wallet->sendTransaction(_transfers, _fee, NodeAdapter::instance().convertPaymentId(_payment_id), _mixin, 0);
   } catch (std::system_error&) {
     unlock();
   }
+
+  return CryptoNote::WALLET_LEGACY_INVALID_TRANSACTION_ID;
 }
 
 // Prerequisites: deduce fee from transfers, selected outs amount and tansfers amount + fee should match
-void WalletAdapter::sendTransaction(const std::vector<CryptoNote::WalletLegacyTransfer>& _transfers, const std::list<CryptoNote::TransactionOutputInformation>& _selectedOuts, quint64 _fee, const QString& _payment_id, quint64 _mixin) {
+CryptoNote::TransactionId WalletAdapter::sendTransaction(const std::vector<CryptoNote::WalletLegacyTransfer>& _transfers, const std::list<CryptoNote::TransactionOutputInformation>& _selectedOuts, quint64 _fee, const QString& _payment_id, quint64 _mixin) {
   Q_CHECK_PTR(m_wallet);
 
   // can validate here that transfer amount + fee = selected outs amounts
@@ -456,10 +584,12 @@ void WalletAdapter::sendTransaction(const std::vector<CryptoNote::WalletLegacyTr
   try {
     lock();
     Q_EMIT walletStateChangedSignal(tr("Sending transaction"));
-    m_wallet->sendTransaction(_transfers, _selectedOuts, _fee, NodeAdapter::instance().convertPaymentId(_payment_id), _mixin, 0);
+    return m_wallet->sendTransaction(_transfers, _selectedOuts, _fee, NodeAdapter::instance().convertPaymentId(_payment_id), _mixin, 0);
   } catch (std::system_error&) {
     unlock();
   }
+
+  return CryptoNote::WALLET_LEGACY_INVALID_TRANSACTION_ID;
 }
 
 void WalletAdapter::registerAccountNumber() {
@@ -531,10 +661,8 @@ bool WalletAdapter::changePassword(const QString& _oldPassword, const QString& _
     if(QFile::exists(source)) {
       QFile::remove(source);
     }
-    // create new encrypted backup
-    if (save(source, true, false)) {
-      m_isBackupInProgress = true;
-    }
+    // create new encrypted backup, the wallet file is saved after it
+    startBackup(source);
   }
 
   return save(true, true);
@@ -546,10 +674,15 @@ void WalletAdapter::setWalletFile(const QString& _path) {
 }
 
 void WalletAdapter::initCompleted(std::error_code _error) {
+  m_isOutputIndexStale = true;
   if (m_file.is_open()) {
     closeFile();
   }
 
+  if (m_mappedFile.isOpen()) {
+    closeMappedFile();
+  }
+
   Q_EMIT walletInitCompletedSignal(_error.value(), QString::fromStdString(_error.message()));
 }
 
@@ -648,67 +781,182 @@ void WalletAdapter::onWalletInitCompleted(int _error, const QString& _errorText)
 }
 
 void WalletAdapter::saveCompleted(std::error_code _error) {
-  if (!_error && !m_isBackupInProgress) {
-    closeFile();
-    renameFile(Settings::instance().getWalletFile() + ".temp", Settings::instance().getWalletFile());
+  // called on the wallet's saver thread once the snapshot is in memory and the wallet
+  // lock is released, so the disk write holds up neither the wallet nor the GUI
+  std::error_code error = _error;
+  if (!error && !writeWalletFile(m_saveFile, *m_saveBuffer.rdbuf())) {
+    m_logger(Logging::ERROR) << "Failed to write wallet file " << m_saveFile.toStdString();
+    error = std::make_error_code(std::errc::io_error);
+  }
+
+  // a failed save leaves the count behind, so the next routine save writes the changes again
+  if (!error && m_isFullSave) {
+    m_savedChangeCount = m_savingChangeCount;
+  }
+
+  // a checkpoint is taken mid-sync, the progress text stays until synchronization completes
+  const bool walletSaved = !error && !m_isBackupInProgress && !m_isCheckpointSave.exchange(false);
+  finishSave();
+  if (walletSaved) {
     Q_EMIT walletStateChangedSignal(tr("Ready"));
     Q_EMIT updateBlockStatusTextWithDelaySignal();
-  } else if (m_isBackupInProgress) {
-    m_isBackupInProgress = false;
-    closeFile();
-  } else {
-    closeFile();
   }
 
-  Q_EMIT walletSaveCompletedSignal(_error.value(), QString::fromStdString(_error.message()));
+  Q_EMIT walletSaveCompletedSignal(error.value(), QString::fromStdString(error.message()));
+}
+
+void WalletAdapter::onWalletSaveCompleted() {
+  if (m_wallet == nullptr || m_isSaveInProgress) {
+    return;
+  }
+
+  // queued backups go first, in the order they were asked for
+  if (!m_pendingBackups.isEmpty()) {
+    startSave(m_pendingBackups.takeFirst(), true, false, true);
+    return;
+  }
+
+  if (!m_isSavePending) {
+    return;
+  }
+
+  const bool details = m_pendingSaveDetails;
+  const bool cache = m_pendingSaveCache;
+  m_isSavePending = false;
+  m_pendingSaveDetails = false;
+  m_pendingSaveCache = false;
+  save(details, cache);
 }
 
 void WalletAdapter::synchronizationProgressUpdated(uint32_t _current, uint32_t _total) {
   if (m_isSynchronized) {
-    m_syncSpeed = 0;
-    m_syncPeriod = 0;
-    m_perfData.clear();
+    m_syncEstimator.reset();
   }
   m_isSynchronized = false;
 
   if (NodeAdapter::instance().isOffline()) {
-    Q_EMIT walletStateChangedSignal(QString(tr("Offline")));
-    Q_EMIT walletSynchronizationProgressUpdatedSignal(_current, _total);
+    postSyncProgress(_current, _total, QString(tr("Offline")));
     return;
   }
 
-  const uint32_t speedCalcPeriod = 10;
-  const uint32_t periodDay = 60 * 60 * 24;
-  const uint32_t syncPeriodMax = std::numeric_limits<uint32_t>::max();
-  bool calcReady = false;
-  uint32_t totalDeltaTime = 0;
-  uint32_t totalDeltaHeight= 0;
-  uint32_t indexElements = m_perfData.empty() ? 0 : m_perfData.size() - 1;
-  for (uint32_t i = indexElements; i > 0; i--) {
-    totalDeltaTime += m_perfData[i - 1].time.secsTo(m_perfData[i].time);
-    totalDeltaHeight += m_perfData[i].height - m_perfData[i - 1].height;
-    if (totalDeltaTime >= speedCalcPeriod) {
-      m_perfData.erase(m_perfData.begin(), m_perfData.begin() + i - 1);
-      calcReady = true;
-      break;
+  // called for every block, the status text is only rebuilt when a report is due
+  QString stateText;
+  if (m_syncEstimator.update(_current, _total)) {
+    const SyncProgress& progress = m_syncEstimator.progress();
+    stateText = synchronizationStateText(progress);
+    if (m_syncEstimator.isLogDue()) {
+      m_logger(Logging::INFO) << "Synchronizing " << progress.current << "/" << progress.total << ", "
+        << static_cast<uint64_t>(progress.blocksPerSecond) << " blocks/s, ETA "
+        << (progress.etaSeconds < 0 ? std::string("unknown") : std::to_string(progress.etaSeconds) + " s");
     }
   }
-  if (calcReady && _total >= _current) {
-    m_syncSpeed = static_cast<uint32_t>(totalDeltaHeight / totalDeltaTime);
-    m_syncPeriod = m_syncSpeed > 0 ? static_cast<uint32_t>((_total - _current) / m_syncSpeed) : syncPeriodMax;
+
+  postSyncProgress(_current, _total, stateText);
+}
+
+void WalletAdapter::postSyncProgress(quint64 _current, quint64 _total, const QString& _stateText) {
+  {
+    QMutexLocker locker(&m_syncProgressMutex);
+    if (m_isSyncProgressPending) {
+      ++m_droppedSyncProgress;
+    }
+
+    m_syncProgressCurrent = _current;
+    m_syncProgressTotal = _total;
+    if (!_stateText.isEmpty()) {
+      m_syncProgressState = _stateText;
+    }
+    m_isSyncProgressPending = true;
   }
-  PerfType perfData = {_current, QTime::currentTime()};
-  m_perfData.push_back(std::move(perfData));
+
+  if (!m_isSyncProgressQueued.exchange(true)) {
+    Q_EMIT flushSyncProgressSignal();
+  }
+}
+
+void WalletAdapter::discardSyncProgress() {
+  QMutexLocker locker(&m_syncProgressMutex);
+  m_isSyncProgressPending = false;
+  m_syncProgressState.clear();
+  if (m_droppedSyncProgress > 0) {
+    m_logger(Logging::DEBUGGING) << "Coalesced " << m_droppedSyncProgress << " synchronization progress updates";
+    m_droppedSyncProgress = 0;
+  }
+}
+
+void WalletAdapter::flushSyncProgress() {
+  const qint64 interval = 1000 / SYNC_PROGRESS_FLUSHES_PER_SECOND;
+  if (m_syncProgressFlushed.isValid() && m_syncProgressFlushed.elapsed() < interval) {
+    if (!m_syncProgressTimer.isActive()) {
+      m_syncProgressTimer.start(static_cast<int>(interval - m_syncProgressFlushed.elapsed()));
+    }
+    return;
+  }
+
+  quint64 current;
+  quint64 total;
+  QString stateText;
+  {
+    QMutexLocker locker(&m_syncProgressMutex);
+    // cleared under the lock, so a value posted after this point queues a new flush
+    m_isSyncProgressQueued = false;
+    if (!m_isSyncProgressPending) {
+      return;
+    }
+
+    current = m_syncProgressCurrent;
+    total = m_syncProgressTotal;
+    stateText.swap(m_syncProgressState);
+    m_isSyncProgressPending = false;
+  }
+
+  m_syncProgressFlushed.restart();
+  if (!stateText.isEmpty()) {
+    Q_EMIT walletStateChangedSignal(stateText);
+  }
+  Q_EMIT walletSynchronizationProgressUpdatedSignal(current, total);
+  checkpointSynchronization(current);
+}
+
+void WalletAdapter::checkpointSynchronization(quint64 _height) {
+  if (!m_checkpointTimer.isValid() || _height < m_checkpointHeight) {
+    m_checkpointHeight = _height;
+    m_checkpointTimer.start();
+    return;
+  }
+
+  if (_height == m_checkpointHeight ||
+      (_height - m_checkpointHeight < SYNC_CHECKPOINT_BLOCKS && !m_checkpointTimer.hasExpired(SYNC_CHECKPOINT_INTERVAL))) {
+    return;
+  }
+
+  // retried on a later flush when the wallet is busy writing
+  if (m_wallet == nullptr || m_isSaveInProgress) {
+    return;
+  }
+
+  m_logger(Logging::INFO) << "Saving synchronization checkpoint at height " << _height;
+  m_checkpointHeight = _height;
+  m_checkpointTimer.restart();
+  m_isCheckpointSave = true;
+  if (!save(true, true)) {
+    m_isCheckpointSave = false;
+  }
+}
+
+QString WalletAdapter::synchronizationStateText(const SyncProgress& _progress) {
+  const int64_t periodDay = 60 * 60 * 24;
+  const uint32_t blocksPerSecond = static_cast<uint32_t>(_progress.blocksPerSecond);
   QString perfMess = "";
-  if (m_syncPeriod > 0) {
-    QDateTime leftTime = QDateTime::fromSecsSinceEpoch(m_syncPeriod).toUTC();
+  if (blocksPerSecond > 0) {
     perfMess += "(";
-    perfMess += QString(tr("%n blocks per second", "", m_syncSpeed));
-    if (m_syncPeriod < syncPeriodMax) {
+    perfMess += QString(tr("%n blocks per second", "", blocksPerSecond));
+    if (_progress.etaSeconds > 0) {
+      QDateTime leftTime = QDateTime::fromSecsSinceEpoch(_progress.etaSeconds).toUTC();
       perfMess += " | ";
       perfMess += QString(tr("est. completion in")) + " ";
-      if (m_syncPeriod >= periodDay) {
-        perfMess += QString(tr("%n day(s) and", "", static_cast<uint32_t>(m_syncPeriod / periodDay))) + " ";
+      if (_progress.etaSeconds >= periodDay) {
+        perfMess += QString(tr("%n day(s) and", "", static_cast<int>(_progress.etaSeconds / periodDay))) + " ";
         perfMess += leftTime.toString("hh:mm");
       } else {
         perfMess += leftTime.toString("hh:mm:ss");
@@ -716,23 +964,28 @@ void WalletAdapter::synchronizationProgressUpdated(uint32_t _current, uint32_t _
     }
     perfMess += ")";
   }
-  Q_EMIT walletStateChangedSignal(QString("%1 %2/%3 %4").arg(tr("Synchronizing")).arg(_current).arg(_total).arg(perfMess));
-  Q_EMIT walletSynchronizationProgressUpdatedSignal(_current, _total);
+
+  return QString("%1 %2/%3 %4").arg(tr("Synchronizing")).arg(_progress.current).arg(_progress.total).arg(perfMess);
 }
 
 void WalletAdapter::synchronizationCompleted(std::error_code _error) {
   if (!_error) {
     m_isSynchronized = true;
+    // a late progress flush must not overwrite the synchronized state
+    discardSyncProgress();
     Q_EMIT updateBlockStatusTextSignal();
     Q_EMIT walletSynchronizationCompletedSignal(_error.value(), QString::fromStdString(_error.message()));
   }
 }
 
 void WalletAdapter::actualBalanceUpdated(uint64_t _actual_balance) {
+  // also reported when outputs unlock with a new block
+  m_isLockedOutputsStale = true;
   Q_EMIT walletActualBalanceUpdatedSignal(_actual_balance);
 }
 
 void WalletAdapter::pendingBalanceUpdated(uint64_t _pending_balance) {
+  m_isLockedOutputsStale = true;
   Q_EMIT walletPendingBalanceUpdatedSignal(_pending_balance);
 }
 
@@ -741,6 +994,8 @@ void WalletAdapter::unmixableBalanceUpdated(uint64_t _dust_balance) {
 }
 
 void WalletAdapter::externalTransactionCreated(CryptoNote::TransactionId _transactionId) {
+  ++m_changeCount;
+  m_isOutputIndexStale = true;
   if (!m_isSynchronized) {
     m_lastWalletTransactionId = _transactionId;
   } else {
@@ -749,6 +1004,8 @@ void WalletAdapter::externalTransactionCreated(CryptoNote::TransactionId _transa
 }
 
 void WalletAdapter::sendTransactionCompleted(CryptoNote::TransactionId _transaction_id, std::error_code _error) {
+  ++m_changeCount;
+  m_isOutputIndexStale = true;
   unlock();
   Q_EMIT walletSendTransactionCompletedSignal(_transaction_id, _error.value(), walletErrorMessage(_error.value()));
   Q_EMIT updateBlockStatusTextWithDelaySignal();
@@ -805,10 +1062,12 @@ void WalletAdapter::onWalletSendTransactionCompleted(CryptoNote::TransactionId _
 
   Q_EMIT walletTransactionCreatedSignal(_transactionId);
 
-  save(true, true);
+  scheduleSave();
 }
 
 void WalletAdapter::transactionUpdated(CryptoNote::TransactionId _transactionId) {
+  ++m_changeCount;
+  m_isOutputIndexStale = true;
   Q_EMIT walletTransactionUpdatedSignal(_transactionId);
 }
 
@@ -847,6 +1106,22 @@ void WalletAdapter::closeFile() {
   unlock();
 }
 
+bool WalletAdapter::openMappedFile(const QString& _file) {
+  lock();
+  if (!m_mappedFile.open(_file)) {
+    m_logger(Logging::ERROR) << "Failed to map wallet file " << _file.toStdString();
+    unlock();
+    return false;
+  }
+
+  return true;
+}
+
+void WalletAdapter::closeMappedFile() {
+  m_mappedFile.close();
+  unlock();
+}
+
 void WalletAdapter::notifyAboutLastTransaction() {
   if (m_lastWalletTransactionId != std::numeric_limits<quint64>::max()) {
     Q_EMIT walletTransactionCreatedSignal(m_lastWalletTransactionId);
@@ -854,12 +1129,6 @@ void WalletAdapter::notifyAboutLastTransaction() {
   }
 }
 
-void WalletAdapter::renameFile(const QString& _oldName, const QString& _newName) {
-  Q_ASSERT(QFile::exists(_oldName));
-  QFile::remove(_newName);
-  QFile::rename(_oldName, _newName);
-}
-
 void WalletAdapter::updateBlockStatusText() {
   if (m_wallet == nullptr) {
     return;
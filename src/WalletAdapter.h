@@ -6,16 +6,19 @@
 
 #pragma once
 
+#include <QElapsedTimer>
 #include <QMutex>
+#include <QWaitCondition>
 #include <QObject>
-#include <QTime>
 #include <QTimer>
 #include <QPushButton>
+#include <QStringList>
 
 #include <list>
 #include <vector>
 #include <atomic>
 #include <fstream>
+#include <sstream>
 
 #include <boost/program_options.hpp>
 
@@ -23,6 +26,9 @@
 #include <IWalletLegacy.h>
 #include "System/Dispatcher.h"
 #include "Wallet/WalletRpcServer.h"
+#include "MappedFileStream.h"
+#include "OutputIndex.h"
+#include "SyncProgressEstimator.h"
 
 namespace WalletGui {
 
@@ -60,13 +66,13 @@ public:
   Crypto::SecretKey getTxKey(Crypto::Hash& txid);
   size_t getUnlockedOutputsCount();
 
-  std::vector<CryptoNote::TransactionOutputInformation> getOutputs();
-  std::vector<CryptoNote::TransactionOutputInformation> getLockedOutputs();
-  std::vector<CryptoNote::TransactionOutputInformation> getUnlockedOutputs();
-  std::vector<CryptoNote::TransactionSpentOutputInformation> getSpentOutputs();
+  // shared snapshot of the outputs, read by const reference for as long as it is held;
+  // rebuilt on the first query after a transaction changes, only the locked set is
+  // refreshed after a balance update
+  std::shared_ptr<const OutputIndex> getOutputIndex();
 
-  void sendTransaction(const std::vector<CryptoNote::WalletLegacyTransfer>& _transfers, quint64 _fee, const QString& _payment_id, quint64 _mixin);
-  void sendTransaction(const std::vector<CryptoNote::WalletLegacyTransfer>& _transfers, const std::list<CryptoNote::TransactionOutputInformation>& _selectedOuts, quint64 _fee, const QString& _payment_id, quint64 _mixin);
+  CryptoNote::TransactionId sendTransaction(const std::vector<CryptoNote::WalletLegacyTransfer>& _transfers, quint64 _fee, const QString& _payment_id, quint64 _mixin);
+  CryptoNote::TransactionId sendTransaction(const std::vector<CryptoNote::WalletLegacyTransfer>& _transfers, const std::list<CryptoNote::TransactionOutputInformation>& _selectedOuts, quint64 _fee, const QString& _payment_id, quint64 _mixin);
 
   void registerAccountNumber();
 
@@ -100,6 +106,7 @@ public:
 
 private:
   std::fstream m_file;
+  MappedFileStream m_mappedFile;
   CryptoNote::IWalletLegacy* m_wallet;
   Tools::wallet_rpc_server* m_wallet_rpc;
   std::unique_ptr<System::Dispatcher> m_rpcDispatcher;
@@ -108,13 +115,47 @@ private:
   std::atomic<bool> m_isSynchronized;
   std::atomic<quint64> m_lastWalletTransactionId;
   QTimer m_newTransactionsNotificationTimer;
+  QTimer m_saveTimer;
+  std::atomic<quint64> m_changeCount;
+  // set by saveCompleted() on the saver thread once the wallet file is committed
+  std::atomic<quint64> m_savedChangeCount;
+  // one save at a time; m_saveFile and m_saveBuffer belong to it until finishSave()
+  QMutex m_saveMutex;
+  QWaitCondition m_saveFinished;
+  std::atomic<bool> m_isSaveInProgress;
+  std::stringstream m_saveBuffer;
+  QString m_saveFile;
+  // the change count the running save captures, and whether it writes everything to the wallet file
+  quint64 m_savingChangeCount;
+  bool m_isFullSave;
+  bool m_isSavePending;
+  bool m_pendingSaveDetails;
+  bool m_pendingSaveCache;
+  // backups asked for while a save was running, written one by one after it
+  QStringList m_pendingBackups;
   QTimer* m_dispatcherTimer = nullptr;
   QPushButton* m_closeButton;
   Logging::LoggerRef m_logger;
-  uint32_t m_syncSpeed;
-  uint32_t m_syncPeriod;
-  struct PerfType { uint32_t height; QTime time; };
-  std::vector<PerfType> m_perfData;
+  QMutex m_outputIndexMutex;
+  std::shared_ptr<const OutputIndex> m_outputIndex;
+  const CryptoNote::IWalletLegacy* m_outputIndexWallet;
+  std::atomic<bool> m_isOutputIndexStale;
+  std::atomic<bool> m_isLockedOutputsStale;
+  SyncProgressEstimator m_syncEstimator;
+  // only the latest sync progress is kept and flushed to the GUI at a bounded rate
+  QMutex m_syncProgressMutex;
+  quint64 m_syncProgressCurrent;
+  quint64 m_syncProgressTotal;
+  QString m_syncProgressState;
+  bool m_isSyncProgressPending;
+  quint64 m_droppedSyncProgress;
+  std::atomic<bool> m_isSyncProgressQueued;
+  QTimer m_syncProgressTimer;
+  QElapsedTimer m_syncProgressFlushed;
+  // the wallet cache is written every so often during a long sync, so a crash resumes from there
+  quint64 m_checkpointHeight;
+  QElapsedTimer m_checkpointTimer;
+  std::atomic<bool> m_isCheckpointSave;
 
   boost::program_options::variables_map m_wrpcOptions;
 
@@ -125,19 +166,33 @@ private:
   void onWalletSendTransactionCompleted(CryptoNote::TransactionId _transaction_id, int _error, const QString& _error_text);
 
   bool importLegacyWallet(const QString &_password);
-  bool save(const QString& _file, bool _details, bool _cache);
+  bool startSave(const QString& _file, bool _details, bool _cache, bool _backup);
+  void finishSave();
+  void waitForSave();
+  void scheduleSave();
+  void startBackup(const QString& _file);
+  void finishPendingBackups();
+  static bool writeWalletFile(const QString& _file, std::streambuf& _data);
   void lock();
   void unlock();
   bool openFile(const QString& _file, bool _read_only);
   void closeFile();
+  bool openMappedFile(const QString& _file);
+  void closeMappedFile();
   void notifyAboutLastTransaction();
   QString walletErrorMessage(int _error_code);
+  QString synchronizationStateText(const SyncProgress& _progress);
+  void postSyncProgress(quint64 _current, quint64 _total, const QString& _stateText);
+  void discardSyncProgress();
+  void checkpointSynchronization(quint64 _height);
   void runWalletRpc();
   void stopWalletRpc();
 
-  static void renameFile(const QString& _old_name, const QString& _new_name);
   Q_SLOT void updateBlockStatusText();
   Q_SLOT void updateBlockStatusTextWithDelay();
+  Q_SLOT void saveIfChanged();
+  Q_SLOT void onWalletSaveCompleted();
+  Q_SLOT void flushSyncProgress();
 
 Q_SIGNALS:
   void walletInitCompletedSignal(int _error, const QString& _error_text);
@@ -159,6 +214,7 @@ Q_SIGNALS:
   void reloadWalletTransactionsSignal();
   void updateBlockStatusTextSignal();
   void updateBlockStatusTextWithDelaySignal();
+  void flushSyncProgressSignal();
 };
 
 }
@@ -12,6 +12,21 @@
 
 namespace WalletGui {
 
+namespace {
+
+QString contactKey(const QString& _address, const QString& _paymentid) {
+  return _address + QLatin1Char('\n') + _paymentid;
+}
+
+// the first row wins, like it does for match()
+void indexKey(QHash<QString, int>& _rows, const QString& _key, int _row) {
+  if (!_rows.contains(_key)) {
+    _rows.insert(_key, _row);
+  }
+}
+
+}
+
 AddressBookModel& AddressBookModel::instance() {
   static AddressBookModel inst;
   return inst;
@@ -106,6 +121,7 @@ void AddressBookModel::addAddress(const QString& _label, const QString& _address
   newAddress.insert("address", _address);
   newAddress.insert("paymentid", _paymentid);
   m_addressBook.append(newAddress);
+  indexRow(m_addressBook.size() - 1);
   endInsertRows();
   saveAddressBook();
 }
@@ -117,6 +133,8 @@ void AddressBookModel::removeAddress(quint32 _row) {
 
   beginRemoveRows(QModelIndex(), _row, _row);
   m_addressBook.removeAt(_row);
+  // later rows move up by one
+  rebuildIndex();
   endRemoveRows();
   saveAddressBook();
 }
@@ -127,6 +145,7 @@ void AddressBookModel::reset() {
     m_addressBook.removeFirst();
   }
 
+  rebuildIndex();
   endResetModel();
 }
 
@@ -150,6 +169,7 @@ void AddressBookModel::walletInitCompleted(int _error, const QString& _error_tex
       }
 
       addressBookFile.close();
+      rebuildIndex();
       if (!m_addressBook.isEmpty()) {
         beginInsertRows(QModelIndex(), 0, m_addressBook.size() - 1);
         endInsertRows();
@@ -158,13 +178,49 @@ void AddressBookModel::walletInitCompleted(int _error, const QString& _error_tex
   }
 }
 
-const QModelIndex AddressBookModel::indexFromContact(const QString& searchstring, const int& column){
-    QModelIndex index = match(AddressBookModel::index(0,column,QModelIndex()),
-            Qt::DisplayRole, searchstring, 1,
-            Qt::MatchFlags(Qt::MatchExactly|Qt::MatchRecursive))
-            .value(0);
+void AddressBookModel::indexRow(int _row) {
+  const QJsonObject contact = m_addressBook.at(_row).toObject();
+  const QString address = contact.value("address").toString();
+  const QString paymentid = contact.value("paymentid").toString();
+  indexKey(m_labelRows, contact.value("label").toString(), _row);
+  indexKey(m_addressRows, address, _row);
+  indexKey(m_paymentIdRows, paymentid, _row);
+  indexKey(m_contactRows, contactKey(address, paymentid), _row);
+}
+
+void AddressBookModel::rebuildIndex() {
+  m_labelRows.clear();
+  m_addressRows.clear();
+  m_paymentIdRows.clear();
+  m_contactRows.clear();
+  for (int row = 0; row < m_addressBook.size(); ++row) {
+    indexRow(row);
+  }
+}
+
+const QModelIndex AddressBookModel::indexFromContact(const QString& searchstring, const int& column) {
+  const QHash<QString, int>* rows = nullptr;
+  switch (column) {
+  case COLUMN_LABEL:
+    rows = &m_labelRows;
+    break;
+  case COLUMN_ADDRESS:
+    rows = &m_addressRows;
+    break;
+  case COLUMN_PAYMENTID:
+    rows = &m_paymentIdRows;
+    break;
+  default:
+    return QModelIndex();
+  }
+
+  const auto it = rows->constFind(searchstring);
+  return it == rows->constEnd() ? QModelIndex() : index(it.value(), column);
+}
 
-    return index;
+const QModelIndex AddressBookModel::indexFromAddress(const QString& _address, const QString& _paymentid) const {
+  const auto it = m_contactRows.constFind(contactKey(_address, _paymentid));
+  return it == m_contactRows.constEnd() ? QModelIndex() : createIndex(it.value(), COLUMN_ADDRESS, it.value());
 }
 
 }
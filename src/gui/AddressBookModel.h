@@ -5,6 +5,7 @@
 #pragma once
 
 #include <QAbstractItemModel>
+#include <QHash>
 #include <QJsonArray>
 
 namespace WalletGui {
@@ -31,14 +32,22 @@ public:
   void removeAddress(quint32 _row);
 
   const QModelIndex indexFromContact(const QString& searchstring, const int& column);
+  const QModelIndex indexFromAddress(const QString& _address, const QString& _paymentid) const;
 
 private:
   QJsonArray m_addressBook;
+  // first row holding each label, address, payment id and address with payment id
+  QHash<QString, int> m_labelRows;
+  QHash<QString, int> m_addressRows;
+  QHash<QString, int> m_paymentIdRows;
+  QHash<QString, int> m_contactRows;
 
   AddressBookModel();
   ~AddressBookModel();
 
   void reset();
+  void indexRow(int _row);
+  void rebuildIndex();
   void saveAddressBook();
   void walletInitCompleted(int _error, const QString& _error_text);
 };
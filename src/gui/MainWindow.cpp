@@ -6,6 +6,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <QCloseEvent>
+#include <QFile>
 #include <QFileDialog>
 #include <QStandardPaths>
 #include <QInputDialog>
@@ -27,6 +28,7 @@
 #include "Common/Util.h"
 #include "CryptoNoteCore/CryptoNoteTools.h"
 #include "AboutDialog.h"
+#include "BatchPayout.h"
 #include "AnimatedLabel.h"
 #include "AddressBookModel.h"
 #include "ChangePasswordDialog.h"
@@ -123,6 +125,13 @@ void MainWindow::connectToSignals() {
     }
   });
   connect(&NodeAdapter::instance(), &NodeAdapter::peerCountUpdatedSignal, this, &MainWindow::peerCountUpdated, Qt::QueuedConnection);
+  connect(&BatchPayout::instance(), &BatchPayout::payoutProgressSignal, this, [this](int _sent, int _total) {
+    setStatusBarText(QString(tr("Batch payout: %1 of %2 transactions processed")).arg(_sent).arg(_total));
+  });
+  connect(&BatchPayout::instance(), &BatchPayout::payoutFinishedSignal, this, [this](int _succeeded, int _failed) {
+    QMessageBox::information(this, tr("Batch payout"),
+      QString(tr("Payout finished: %1 transaction(s) sent, %2 failed.")).arg(_succeeded).arg(_failed), QMessageBox::Ok);
+  });
   connect(m_ui->m_exitAction, &QAction::triggered, qApp, &QApplication::quit);
   connect(m_ui->m_sendFrame, &SendFrame::uriOpenSignal, this, &MainWindow::onUriOpenSignal, Qt::QueuedConnection);
   connect(m_ui->m_noWalletFrame, &NoWalletFrame::createWalletClickedSignal, this, &MainWindow::createWallet, Qt::QueuedConnection);
@@ -595,6 +604,7 @@ void MainWindow::isTrackingMode() {
   m_ui->m_openUriAction->setEnabled(false);
   m_ui->m_showMnemonicSeedAction->setEnabled(false);
   m_ui->m_proofBalanceAction->setEnabled(false);
+  m_ui->m_batchPayoutAction->setEnabled(false);
   m_trackingModeIconLabel->show();
 }
 
@@ -746,6 +756,55 @@ void MainWindow::getBalanceProof() {
   dlg.exec();
 }
 
+void MainWindow::batchPayout() {
+  if (BatchPayout::instance().isRunning()) {
+    QMessageBox::information(this, tr("Batch payout"), tr("A payout is already in progress."), QMessageBox::Ok);
+    return;
+  }
+
+  QString filePath = QFileDialog::getOpenFileName(this, tr("Open payout list"), QDir::homePath(),
+    tr("Payout lists (*.csv *.txt);;All files (*)"));
+  if (filePath.isEmpty()) {
+    return;
+  }
+
+  QFile file(filePath);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    QMessageBox::critical(this, tr("Batch payout"), tr("Cannot open the payout list."), QMessageBox::Ok);
+    return;
+  }
+
+  // same range and default as the send form's ring size slider
+  bool ok = false;
+  const int mixin = QInputDialog::getInt(this, tr("Batch payout"), tr("Mixin count:"), 7, 0, 19, 1, &ok);
+  if (!ok) {
+    return;
+  }
+
+  QVector<BatchPayout::Recipient> recipients;
+  QString error;
+  if (!BatchPayout::parseRecipients(QString::fromUtf8(file.readAll()), recipients, error) ||
+      !BatchPayout::instance().plan(recipients, NodeAdapter::instance().getMinimalFee(), static_cast<quint64>(mixin), error)) {
+    QMessageBox::critical(this, tr("Batch payout"), error, QMessageBox::Ok);
+    return;
+  }
+
+  const QString ticker = CurrencyAdapter::instance().getCurrencyTicker().toUpper();
+  const QString summary = QString(tr("Send %1 %2 to %3 recipient(s) in %4 transaction(s)? Fees total %5 %2."))
+    .arg(CurrencyAdapter::instance().formatAmount(BatchPayout::instance().totalAmount())).arg(ticker)
+    .arg(BatchPayout::instance().recipientCount()).arg(BatchPayout::instance().transactionCount())
+    .arg(CurrencyAdapter::instance().formatAmount(BatchPayout::instance().totalFee()));
+  if (QMessageBox::question(this, tr("Batch payout"), summary, QMessageBox::Yes | QMessageBox::No) != QMessageBox::Yes) {
+    return;
+  }
+
+  if (!confirmWithPassword()) {
+    return;
+  }
+
+  BatchPayout::instance().start();
+}
+
 void MainWindow::showStatusInfo() {
   InfoDialog dlg(this);
   dlg.exec();
@@ -1109,6 +1168,7 @@ void MainWindow::walletOpened(bool _error, const QString& _error_text) {
     m_ui->m_verifySignedMessageAction->setEnabled(true);
     if (WalletAdapter::instance().getActualBalance() != 0)
         m_ui->m_proofBalanceAction->setEnabled(true);
+    m_ui->m_batchPayoutAction->setEnabled(true);
     if(WalletAdapter::instance().isDeterministic()) {
        m_ui->m_showMnemonicSeedAction->setEnabled(true);
     }
@@ -1152,6 +1212,7 @@ void MainWindow::walletClosed() {
   m_ui->m_signMessageAction->setEnabled(false);
   m_ui->m_verifySignedMessageAction->setEnabled(false);
   m_ui->m_proofBalanceAction->setEnabled(false);
+  m_ui->m_batchPayoutAction->setEnabled(false);
   m_ui->m_lockWalletAction->setEnabled(false);
   accountWidget->setVisible(false);
   m_ui->m_receiveFrame->hide();
@@ -141,6 +141,7 @@ private:
   Q_SLOT void showMnemonicSeed();
   Q_SLOT void restoreFromMnemonicSeed();
   Q_SLOT void getBalanceProof();
+  Q_SLOT void batchPayout();
   Q_SLOT void lockWalletWithPassword();
   Q_SLOT void openWalletRpcSettings();
 
@@ -20,6 +20,7 @@
 #include "CryptoNoteWrapper.h"
 #include "CurrencyAdapter.h"
 #include "Settings.h"
+#include "CpuTopology.h"
 #include "Logging/LoggerManager.h"
 #include "LoggerAdapter.h"
 #include "LogFileWatcher.h"
@@ -35,7 +36,6 @@
 namespace WalletGui {
 
 const quint32 HASHRATE_TIMER_INTERVAL = 1000;
-const quint32 MINER_ROUTINE_TIMER_INTERVAL = 60000;
 
 namespace {
 
@@ -148,12 +148,13 @@ QString eventColor(const QString& kind) {
 MiningFrame::MiningFrame(QWidget* _parent) :
     QFrame(_parent), m_ui(new Ui::MiningFrame),
     m_soloHashRateTimerId(-1),
-    m_minerRoutineTimerId(-1),
     m_miner(new Miner(this, LoggerAdapter::instance().getLoggerManager())),
     m_coreLogWatcher(new LogFileWatcher(Settings::instance().getDataDir().absoluteFilePath(QCoreApplication::applicationName() + ".log"), this)) {
   m_ui->setupUi(this);
   setMiningStatusBadge(tr("Stopped"), QStringLiteral("rgba(191, 92, 92, 70)"), QStringLiteral("#7f3030"));
   initCpuCoreList();
+  initCpuAffinityList();
+  initThrottle();
 
   QFont fixedFont = QFontDatabase::systemFont(QFontDatabase::FixedFont);
   fixedFont.setStyleHint(QFont::TypeWriter);
@@ -198,6 +199,10 @@ MiningFrame::MiningFrame(QWidget* _parent) :
   connect(m_ui->m_cpuBalancedPreset, &QPushButton::clicked, this, [this]() { applyCpuPreset(0.5); });
   connect(m_ui->m_cpuMaxPreset, &QPushButton::clicked, this, [this]() { applyCpuPreset(1); });
   connect(m_ui->m_cpuCoresSpin, static_cast<void(QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, [this](int) { updateCpuIntensity(); });
+  connect(m_ui->m_cpuAffinityCombo, static_cast<void(QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this, &MiningFrame::cpuAffinityChanged);
+  connect(m_ui->m_throttleCheck, &QCheckBox::toggled, this, &MiningFrame::throttleSettingsChanged);
+  connect(m_ui->m_throttleCpuSpin, static_cast<void(QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &MiningFrame::throttleSettingsChanged);
+  connect(m_ui->m_throttleTemperatureSpin, static_cast<void(QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &MiningFrame::throttleSettingsChanged);
   m_threadResizeTimer.setSingleShot(true);
   connect(&m_threadResizeTimer, &QTimer::timeout, this, &MiningFrame::applyPendingMiningThreads);
 
@@ -208,7 +213,6 @@ MiningFrame::MiningFrame(QWidget* _parent) :
   connect(&WalletAdapter::instance(), &WalletAdapter::walletSynchronizationCompletedSignal, this, &MiningFrame::onSynchronizationCompleted, Qt::QueuedConnection);
   connect(&NodeAdapter::instance(), &NodeAdapter::localBlockchainUpdatedSignal, this, &MiningFrame::onBlockHeightUpdated, Qt::QueuedConnection);
   connect(&NodeAdapter::instance(), &NodeAdapter::peerCountUpdatedSignal, this, &MiningFrame::onPeerCountUpdated, Qt::QueuedConnection);
-  connect(&NodeAdapter::instance(), &NodeAdapter::poolChangedSignal, this, &MiningFrame::poolChanged,Qt::QueuedConnection);
   connect(&*m_miner, &Miner::minerMessageSignal, this, &MiningFrame::updateMinerLog, Qt::QueuedConnection);
   connect(&*m_miner, &Miner::minerStartedSignal, this, &MiningFrame::onMinerStarted, Qt::QueuedConnection);
   connect(&*m_miner, &Miner::minerStoppedSignal, this, &MiningFrame::onMinerStopped, Qt::QueuedConnection);
@@ -216,6 +220,7 @@ MiningFrame::MiningFrame(QWidget* _parent) :
   connect(&*m_miner, &Miner::minerTemplateUpdatedSignal, this, &MiningFrame::onMinerTemplateUpdated, Qt::QueuedConnection);
   connect(&*m_miner, &Miner::blockFoundSignal, this, &MiningFrame::onBlockFound, Qt::QueuedConnection);
   connect(&*m_miner, &Miner::miningErrorSignal, this, &MiningFrame::onMinerError, Qt::QueuedConnection);
+  connect(&*m_miner, &Miner::minerThrottleSignal, this, &MiningFrame::onMinerThrottleChanged, Qt::QueuedConnection);
   connect(m_coreLogWatcher, &LogFileWatcher::newLogStringSignal, this, &MiningFrame::updateCoreLog, Qt::QueuedConnection);
 }
 
@@ -624,16 +629,14 @@ void MiningFrame::timerEvent(QTimerEvent* _event) {
 
     setMiningStatusBadge(tr("Mining"), QStringLiteral("rgba(91, 171, 118, 65)"), QStringLiteral("#246d3f"));
     m_ui->m_hashratelcdNumber->display(hashRate);
+    updateThreadHashRates();
+    updateTemplateStats();
     addPoint(QDateTime::currentDateTime().toSecsSinceEpoch(), hashRate);
     updateSessionStats();
     plot();
 
     return;
   }
-  if (_event->timerId() == m_minerRoutineTimerId) {
-    m_miner->on_block_chain_update();
-  }
-
   QFrame::timerEvent(_event);
 }
 
@@ -669,6 +672,89 @@ void MiningFrame::initCpuCoreList() {
   updateCpuIntensity();
 }
 
+void MiningFrame::initCpuAffinityList() {
+  m_ui->m_cpuAffinityCombo->addItem(tr("Scheduler"), static_cast<int>(MiningAffinity::NONE));
+  m_ui->m_cpuAffinityCombo->addItem(tr("Physical cores first"), static_cast<int>(MiningAffinity::PHYSICAL_FIRST));
+  m_ui->m_cpuAffinityCombo->addItem(tr("Compact (per NUMA node)"), static_cast<int>(MiningAffinity::COMPACT));
+
+  if (!isCpuPinningSupported()) {
+    m_ui->m_cpuAffinityCombo->setEnabled(false);
+    return;
+  }
+
+  const int index = m_ui->m_cpuAffinityCombo->findData(static_cast<int>(Settings::instance().getMiningAffinity()));
+  m_ui->m_cpuAffinityCombo->setCurrentIndex(index >= 0 ? index : 0);
+  m_miner->set_affinity_policy(static_cast<MiningAffinity>(m_ui->m_cpuAffinityCombo->currentData().toInt()));
+}
+
+void MiningFrame::setCpuAffinityEditable(bool _editable) {
+  m_ui->m_cpuAffinityCombo->setEnabled(_editable && isCpuPinningSupported());
+}
+
+void MiningFrame::initThrottle() {
+  m_ui->m_throttleCheck->setChecked(Settings::instance().isMiningThrottleEnabled());
+  m_ui->m_throttleCpuSpin->setValue(Settings::instance().getMiningMaxCpuShare());
+  m_ui->m_throttleTemperatureSpin->setValue(Settings::instance().getMiningMaxTemperature());
+  m_ui->m_throttleCpuSpin->setEnabled(m_ui->m_throttleCheck->isChecked());
+  m_ui->m_throttleTemperatureSpin->setEnabled(m_ui->m_throttleCheck->isChecked());
+  m_miner->set_adaptive_throttle(m_ui->m_throttleCheck->isChecked(), m_ui->m_throttleCpuSpin->value(), m_ui->m_throttleTemperatureSpin->value());
+}
+
+void MiningFrame::throttleSettingsChanged() {
+  const bool enabled = m_ui->m_throttleCheck->isChecked();
+  m_ui->m_throttleCpuSpin->setEnabled(enabled);
+  m_ui->m_throttleTemperatureSpin->setEnabled(enabled);
+  Settings::instance().setMiningThrottleEnabled(enabled);
+  Settings::instance().setMiningMaxCpuShare(m_ui->m_throttleCpuSpin->value());
+  Settings::instance().setMiningMaxTemperature(m_ui->m_throttleTemperatureSpin->value());
+  m_miner->set_adaptive_throttle(enabled, m_ui->m_throttleCpuSpin->value(), m_ui->m_throttleTemperatureSpin->value());
+  if (!enabled) {
+    m_ui->m_throttleStatusLabel->clear();
+  }
+}
+
+void MiningFrame::onMinerThrottleChanged(quint32 _activeThreads, quint32 _maxThreads, double _load, double _temperature, bool _paused) {
+  if (!m_ui->m_throttleCheck->isChecked()) {
+    m_ui->m_throttleStatusLabel->clear();
+    return;
+  }
+
+  QStringList parts;
+  parts.append(_paused ? tr("paused") : tr("%1/%2 threads").arg(_activeThreads).arg(_maxThreads));
+  if (_load >= 0) {
+    parts.append(tr("CPU %1%").arg(QString::number(_load, 'f', 0)));
+  }
+  if (_temperature >= 0) {
+    parts.append(tr("%1 °C").arg(QString::number(_temperature, 'f', 0)));
+  }
+
+  m_ui->m_throttleStatusLabel->setText(parts.join(QStringLiteral(", ")));
+  if (_paused != m_throttlePaused) {
+    m_throttlePaused = _paused;
+    appendMiningEvent(QStringLiteral("CPU"), _paused ? tr("Mining paused, the computer is busy or hot") : tr("Mining resumed"));
+  }
+}
+
+void MiningFrame::updateThreadHashRates() {
+  QStringList lines;
+  lines.append(tr("Total: %1 (average %2)").arg(formatHashRate(m_miner->get_current_speed())).arg(formatHashRate(m_miner->get_speed())));
+  for (const Miner::thread_hash_rate& thread : m_miner->get_thread_speeds()) {
+    const QString cpu = thread.cpu >= 0 ? tr("CPU %1").arg(thread.cpu) : tr("unpinned");
+    lines.append(tr("Thread %1 (%2): %3").arg(thread.index).arg(cpu).arg(formatHashRate(thread.hash_rate)));
+  }
+
+  m_ui->m_hashratelcdNumber->setToolTip(lines.join(QLatin1Char('\n')));
+}
+
+void MiningFrame::updateTemplateStats() {
+  const Miner::template_stats stats = m_miner->get_template_stats();
+  m_ui->m_difficulty->setToolTip(tr("Template refreshes: %1 (%2 events coalesced)\nStale after new blocks: %3 ms\nOutdated after pool changes: %4 ms")
+      .arg(stats.refreshes)
+      .arg(stats.coalesced_events)
+      .arg(stats.stale_chain_ms)
+      .arg(stats.stale_pool_ms));
+}
+
 void MiningFrame::walletOpened() {
   if(m_solo_mining)
     stopSolo();
@@ -702,11 +788,6 @@ void MiningFrame::stopMiningForShutdown() {
     m_soloHashRateTimerId = -1;
   }
 
-  if (m_minerRoutineTimerId != -1) {
-    killTimer(m_minerRoutineTimerId);
-    m_minerRoutineTimerId = -1;
-  }
-
   m_miner->stop();
   m_solo_mining = false;
   m_mining_was_stopped = true;
@@ -736,8 +817,8 @@ void MiningFrame::startSolo() {
   }
 
   setMiningStatusBadge(tr("Starting..."), QStringLiteral("rgba(219, 178, 83, 75)"), QStringLiteral("#7a5a16"));
+  setCpuAffinityEditable(false);
   m_soloHashRateTimerId = startTimer(HASHRATE_TIMER_INTERVAL);
-  m_minerRoutineTimerId = startTimer(MINER_ROUTINE_TIMER_INTERVAL);
   m_ui->m_startSolo->setChecked(true);
   m_ui->m_startSolo->setEnabled(false);
   m_ui->m_stopSolo->setEnabled(true);
@@ -749,12 +830,11 @@ void MiningFrame::stopSolo(bool _stoppedByNoPeers) {
   if(m_solo_mining) {
     killTimer(m_soloHashRateTimerId);
     m_soloHashRateTimerId = -1;
-    killTimer(m_minerRoutineTimerId);
-    m_minerRoutineTimerId = -1;
     m_miner->stop();
     addPoint(QDateTime::currentDateTime().toSecsSinceEpoch(), 0);
     setMiningStatusBadge(tr("Stopped"), QStringLiteral("rgba(191, 92, 92, 70)"), QStringLiteral("#7f3030"));
     m_ui->m_hashratelcdNumber->display(0.0);
+    m_ui->m_hashratelcdNumber->setToolTip(QString());
     m_lastHashRate = 0;
     updateSessionStats();
     plot();
@@ -766,6 +846,7 @@ void MiningFrame::stopSolo(bool _stoppedByNoPeers) {
       m_ui->m_cpuEcoPreset->setEnabled(true);
       m_ui->m_cpuBalancedPreset->setEnabled(true);
       m_ui->m_cpuMaxPreset->setEnabled(true);
+      setCpuAffinityEditable(true);
     }
     m_solo_mining = false;
     m_mining_was_stopped = !_stoppedByNoPeers;
@@ -803,10 +884,7 @@ void MiningFrame::setMiningThreads() {
 }
 
 void MiningFrame::onBlockHeightUpdated(quint64 _height) {
-  if (m_miner->is_mining()) {
-    m_miner->on_block_chain_update();
-  }
-
+  // the miner refreshes its template from the same signal
   if (m_solo_mining) {
     appendMiningEvent(QStringLiteral("CHAIN"), tr("New block %1, refreshing template").arg(_height));
     addHashRateEventMarker(false);
@@ -886,14 +964,12 @@ void MiningFrame::onMinerStopped(quint32 _threads) {
     m_soloHashRateTimerId = -1;
   }
 
-  if (m_minerRoutineTimerId != -1) {
-    killTimer(m_minerRoutineTimerId);
-    m_minerRoutineTimerId = -1;
-  }
-
   addPoint(QDateTime::currentDateTime().toSecsSinceEpoch(), 0);
   setMiningStatusBadge(tr("Stopped"), QStringLiteral("rgba(191, 92, 92, 70)"), QStringLiteral("#7f3030"));
   m_ui->m_hashratelcdNumber->display(0.0);
+  m_ui->m_hashratelcdNumber->setToolTip(QString());
+  m_ui->m_throttleStatusLabel->clear();
+  m_throttlePaused = false;
   m_lastHashRate = 0;
   updateSessionStats();
   plot();
@@ -906,6 +982,7 @@ void MiningFrame::onMinerStopped(quint32 _threads) {
     m_ui->m_cpuEcoPreset->setEnabled(true);
     m_ui->m_cpuBalancedPreset->setEnabled(true);
     m_ui->m_cpuMaxPreset->setEnabled(true);
+    setCpuAffinityEditable(true);
   }
 
   m_solo_mining = false;
@@ -951,9 +1028,10 @@ void MiningFrame::coreDealTurned(int _cores) {
   scheduleMiningThreadsChange(_cores);
 }
 
-void MiningFrame::poolChanged() {
-  if (m_miner->is_mining()) {
-    m_miner->on_block_chain_update();
+void MiningFrame::cpuAffinityChanged(int _index) {
+  const MiningAffinity policy = static_cast<MiningAffinity>(m_ui->m_cpuAffinityCombo->itemData(_index).toInt());
+  if (m_miner->set_affinity_policy(policy)) {
+    Settings::instance().setMiningAffinity(static_cast<quint8>(policy));
   }
 }
 
@@ -48,7 +48,6 @@ protected:
 private:
   QScopedPointer<Ui::MiningFrame> m_ui;
   int m_soloHashRateTimerId;
-  int m_minerRoutineTimerId;
   QVector<double> m_hX, m_hY, m_averageHashRateY;
   QVector<double> m_difficultyX, m_difficultyY;
   QList<QCPItemLine*> m_hashRateEventMarkers;
@@ -61,6 +60,11 @@ private:
   int m_pendingMiningThreads = 0;
 
   void initCpuCoreList();
+  void initCpuAffinityList();
+  void setCpuAffinityEditable(bool _editable);
+  void initThrottle();
+  void updateThreadHashRates();
+  void updateTemplateStats();
   void startSolo();
   void stopSolo(bool _stoppedByNoPeers = false);
 
@@ -69,6 +73,7 @@ private:
   bool m_sychronized = false;
   bool m_mining_was_stopped = false;
   bool m_miningStoppedByNoPeers = false;
+  bool m_throttlePaused = false;
   QDateTime m_sessionStartedAt;
   double m_sessionTotalHashes = 0;
   double m_roundHashes = 0;
@@ -117,7 +122,9 @@ private:
   Q_SLOT void onBlockFound(const QString& _hash, quint64 _height, quint64 _difficulty, const QString& _pow);
   Q_SLOT void onMinerError(const QString& _message);
   Q_SLOT void coreDealTurned(int _cores);
-  Q_SLOT void poolChanged();
+  Q_SLOT void cpuAffinityChanged(int _index);
+  Q_SLOT void throttleSettingsChanged();
+  Q_SLOT void onMinerThrottleChanged(quint32 _activeThreads, quint32 _maxThreads, double _load, double _temperature, bool _paused);
 };
 
 }
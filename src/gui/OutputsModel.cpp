@@ -5,8 +5,11 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <algorithm>
+#include <cstring>
+#include <QHash>
 #include <QIcon>
 #include <QMetaEnum>
+#include <QSet>
 
 #include "CryptoNoteCore/CryptoNoteTools.h"
 #include "Common/StringTools.h"
@@ -20,8 +23,59 @@ namespace WalletGui {
 const int OUTPUTS_MODEL_COLUMN_COUNT =
   OutputsModel::staticMetaObject.enumerator(OutputsModel::staticMetaObject.indexOfEnumerator("Columns")).keyCount();
 
+namespace {
+
+CryptoNote::TransactionSpentOutputInformation toSpentOutput(const CryptoNote::TransactionOutputInformation& _output) {
+  //CryptoNote::TransactionSpentOutputInformation s = *static_cast<const CryptoNote::TransactionSpentOutputInformation *>(&o); // crashes here
+  CryptoNote::TransactionSpentOutputInformation s;
+  s.type = _output.type;
+  s.amount = _output.amount;
+  s.globalOutputIndex = _output.globalOutputIndex;
+  s.outputInTransaction = _output.outputInTransaction;
+  s.transactionHash = _output.transactionHash;
+  s.transactionPublicKey = _output.transactionPublicKey;
+  s.outputKey = _output.outputKey;
+  s.requiredSignatures = _output.requiredSignatures;
+
+  s.spendingBlockHeight = std::numeric_limits<uint32_t>::max();
+  s.spendingTransactionHash = CryptoNote::NULL_HASH;
+  s.timestamp = 0;
+  s.keyImage = {};
+  s.inputInTransaction = std::numeric_limits<uint32_t>::max();
+  return s;
+}
+
+// transaction hash and index in it, the identity of an output whatever its state and global index
+QByteArray outputId(const CryptoNote::TransactionOutputInformation& _output) {
+  QByteArray id(reinterpret_cast<const char*>(&_output.transactionHash), sizeof(_output.transactionHash));
+  id.append(reinterpret_cast<const char*>(&_output.outputInTransaction), sizeof(_output.outputInTransaction));
+  return id;
+}
+
+bool isSameOutput(const CryptoNote::TransactionOutputInformation& _left, const CryptoNote::TransactionOutputInformation& _right) {
+  return _left.transactionHash == _right.transactionHash && _left.outputInTransaction == _right.outputInTransaction;
+}
+
+bool hashLessThan(const Crypto::Hash& _left, const Crypto::Hash& _right) {
+  return std::memcmp(&_left, &_right, sizeof(_left)) < 0;
+}
+
+// _hashes is sorted by hashLessThan()
+bool containsHash(const std::vector<Crypto::Hash>& _hashes, const Crypto::Hash& _hash) {
+  return std::binary_search(_hashes.begin(), _hashes.end(), _hash, hashLessThan);
+}
+
+// transaction callbacks come in bursts while the wallet synchronizes, each pass costs O(all outputs)
+const int OUTPUTS_APPLY_DELAY = 100;
+
+}
+
 OutputsModel::OutputsModel() : QAbstractItemModel()
 {
+  m_applyTimer.setSingleShot(true);
+  m_applyTimer.setInterval(OUTPUTS_APPLY_DELAY);
+  connect(&m_applyTimer, &QTimer::timeout, this, &OutputsModel::applyTransactions);
+
   connect(&WalletAdapter::instance(), &WalletAdapter::reloadWalletTransactionsSignal, this, &OutputsModel::reloadWalletTransactions,
           Qt::QueuedConnection);
 
@@ -38,6 +92,21 @@ OutputsModel::OutputsModel() : QAbstractItemModel()
 OutputsModel::~OutputsModel() {
 }
 
+// pending outputs all share the maximal global index, the identity breaks the tie
+bool OutputsModel::transactionSpentOutputInformationLessThan(const CryptoNote::TransactionSpentOutputInformation &left,
+                                                             const CryptoNote::TransactionSpentOutputInformation &right) {
+  if (left.globalOutputIndex != right.globalOutputIndex) {
+    return left.globalOutputIndex < right.globalOutputIndex;
+  }
+
+  const int hash = std::memcmp(&left.transactionHash, &right.transactionHash, sizeof(left.transactionHash));
+  if (hash != 0) {
+    return hash < 0;
+  }
+
+  return left.outputInTransaction < right.outputInTransaction;
+}
+
 OutputsModel& OutputsModel::instance() {
   static OutputsModel inst;
   return inst;
@@ -435,52 +504,112 @@ QVariant OutputsModel::getUserRole(const QModelIndex& _index, int _role, CryptoN
 
 void OutputsModel::reloadWalletTransactions() {
   reset();
-  std::vector<CryptoNote::TransactionOutputInformation> unspent = WalletAdapter::instance().getOutputs();
-  std::vector<CryptoNote::TransactionSpentOutputInformation> spent = WalletAdapter::instance().getSpentOutputs();
+  const std::shared_ptr<const OutputIndex> index = WalletAdapter::instance().getOutputIndex();
+  const std::vector<CryptoNote::TransactionOutputInformation>& unspent = index->unspent();
+  const std::vector<CryptoNote::TransactionSpentOutputInformation>& spent = index->spent();
+  m_outputs.reserve(static_cast<int>(unspent.size() + spent.size()));
   for (const auto &item : spent) {
     m_outputs.append(item);
   }
 
-  spent.clear();
-  spent.shrink_to_fit();
-
-  quint32 outputsCount = unspent.size() + m_outputs.size();
-
   for (const auto& o : unspent) {
-    //CryptoNote::TransactionSpentOutputInformation s = *static_cast<const CryptoNote::TransactionSpentOutputInformation *>(&o); // crashes here
-    CryptoNote::TransactionSpentOutputInformation s;
-    s.type = o.type;
-    s.amount = o.amount;
-    s.globalOutputIndex = o.globalOutputIndex;
-    s.outputInTransaction = o.outputInTransaction;
-    s.transactionHash = o.transactionHash;
-    s.transactionPublicKey = o.transactionPublicKey;
-    s.outputKey = o.outputKey;
-    s.requiredSignatures = o.requiredSignatures;
-
-    s.spendingBlockHeight = std::numeric_limits<uint32_t>::max();
-    s.spendingTransactionHash = CryptoNote::NULL_HASH;
-    s.timestamp = 0;
-    s.keyImage = {};
-    s.inputInTransaction = std::numeric_limits<uint32_t>::max();
-
-    m_outputs.append(s);
-  }
-  unspent.clear();
+    m_outputs.append(toSpentOutput(o));
+  }
 
   // need to sort them
   std::sort(m_outputs.begin(), m_outputs.end(), transactionSpentOutputInformationLessThan);
 
-  beginInsertRows(QModelIndex(), 0, outputsCount - 1);
-  endInsertRows();
+  if (!m_outputs.isEmpty()) {
+    beginInsertRows(QModelIndex(), 0, m_outputs.size() - 1);
+    endInsertRows();
+  }
 }
 
+// Only the rows of the outputs the changed transactions received, spent or
+// gave back on cancel are updated in place or moved, the view is never reset.
+// Finding them still costs O(all outputs) per pass: IWalletLegacy can't list a
+// transaction's outputs, so they are picked out of the OutputIndex snapshot,
+// which the wallet rebuilds after transaction changes. Changes that arrive
+// within OUTPUTS_APPLY_DELAY share one pass.
 void OutputsModel::appendTransaction(CryptoNote::TransactionId _id) {
-  Q_UNUSED(_id);
-  reloadWalletTransactions();
+  CryptoNote::WalletLegacyTransaction transaction;
+  if (!WalletAdapter::instance().getTransaction(_id, transaction)) {
+    return;
+  }
+
+  m_pendingTransactions.push_back(transaction.hash);
+  if (!m_applyTimer.isActive()) {
+    m_applyTimer.start();
+  }
+}
+
+void OutputsModel::applyTransactions() {
+  std::vector<Crypto::Hash> hashes;
+  hashes.swap(m_pendingTransactions);
+  std::sort(hashes.begin(), hashes.end(), hashLessThan);
+  hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+  if (hashes.empty()) {
+    return;
+  }
+
+  QVector<int> relatedRows;
+  QSet<QByteArray> relatedIds;
+  for (int row = 0; row < m_outputs.size(); ++row) {
+    const CryptoNote::TransactionSpentOutputInformation& output = m_outputs[row];
+    if (containsHash(hashes, output.transactionHash) || containsHash(hashes, output.spendingTransactionHash)) {
+      relatedRows.append(row);
+      relatedIds.insert(outputId(output));
+    }
+  }
+
+  const std::shared_ptr<const OutputIndex> index = WalletAdapter::instance().getOutputIndex();
+  QHash<QByteArray, CryptoNote::TransactionSpentOutputInformation> changed;
+  for (const auto& o : index->unspent()) {
+    if (containsHash(hashes, o.transactionHash) || (!relatedIds.isEmpty() && relatedIds.contains(outputId(o)))) {
+      changed.insert(outputId(o), toSpentOutput(o));
+    }
+  }
+
+  for (const auto& o : index->spent()) {
+    if (containsHash(hashes, o.transactionHash) || containsHash(hashes, o.spendingTransactionHash) ||
+        (!relatedIds.isEmpty() && relatedIds.contains(outputId(o)))) {
+      changed.insert(outputId(o), o);
+    }
+  }
+
+  // from the last row down, so the rows still to be removed keep their numbers
+  for (int i = relatedRows.size() - 1; i >= 0; --i) {
+    const int row = relatedRows[i];
+    const auto it = changed.constFind(outputId(m_outputs[row]));
+    if (it == changed.constEnd() || it->globalOutputIndex != m_outputs[row].globalOutputIndex) {
+      beginRemoveRows(QModelIndex(), row, row);
+      m_outputs.remove(row);
+      endRemoveRows();
+    }
+  }
+
+  for (const auto& output : changed) {
+    updateOutput(output);
+  }
+}
+
+void OutputsModel::updateOutput(const CryptoNote::TransactionSpentOutputInformation& _output) {
+  const auto it = std::lower_bound(m_outputs.begin(), m_outputs.end(), _output, transactionSpentOutputInformationLessThan);
+  const int row = static_cast<int>(it - m_outputs.begin());
+  if (it != m_outputs.end() && isSameOutput(*it, _output)) {
+    *it = _output;
+    Q_EMIT dataChanged(index(row, 0), index(row, columnCount() - 1));
+    return;
+  }
+
+  beginInsertRows(QModelIndex(), row, row);
+  m_outputs.insert(row, _output);
+  endInsertRows();
 }
 
 void OutputsModel::reset() {
+  m_applyTimer.stop();
+  m_pendingTransactions.clear();
   beginResetModel();
   m_outputs.clear();
   endResetModel();
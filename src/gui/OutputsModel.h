@@ -9,6 +9,9 @@
 #include <QVector>
 #include <QAbstractItemModel>
 #include <QSortFilterProxyModel>
+#include <QTimer>
+
+#include <vector>
 
 #include <IWalletLegacy.h>
 
@@ -46,13 +49,14 @@ public:
   QModelIndex parent(const QModelIndex& _index) const Q_DECL_OVERRIDE;
 
 private:
+  // kept sorted by transactionSpentOutputInformationLessThan(), so rows can be found and placed by binary search
   QVector<CryptoNote::TransactionSpentOutputInformation> m_outputs;
+  // transactions changed since the last applyTransactions(), applied together in one pass
+  std::vector<Crypto::Hash> m_pendingTransactions;
+  QTimer m_applyTimer;
 
   static bool transactionSpentOutputInformationLessThan(const CryptoNote::TransactionSpentOutputInformation &left,
-                                                 const CryptoNote::TransactionSpentOutputInformation &right)
-  {
-      return left.globalOutputIndex < right.globalOutputIndex;
-  }
+                                                 const CryptoNote::TransactionSpentOutputInformation &right);
 
   OutputsModel();
   ~OutputsModel();
@@ -66,6 +70,8 @@ private:
 
   void reloadWalletTransactions();
   void appendTransaction(CryptoNote::TransactionId _id);
+  void applyTransactions();
+  void updateOutput(const CryptoNote::TransactionSpentOutputInformation& _output);
   void reset();
 };
 
@@ -0,0 +1,170 @@
+// Copyright (c) 2016-2026 The Karbowanec developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "SearchIndex.h"
+
+namespace WalletGui {
+
+namespace {
+
+const int SEARCH_DEBOUNCE_MSEC = 200;
+const int CANCEL_CHECK_ROWS = 4096;
+
+}
+
+SearchIndex::SearchIndex(QAbstractItemModel* _model, KeyFunction _keyFunction, QObject* _parent) : QObject(_parent),
+  m_model(_model), m_keyFunction(std::move(_keyFunction)), m_generation(0),
+  m_request(std::make_shared<std::atomic<quint64>>(0)), m_isEvaluating(false) {
+  m_pool.setMaxThreadCount(1);
+  m_debounceTimer.setSingleShot(true);
+  m_debounceTimer.setInterval(SEARCH_DEBOUNCE_MSEC);
+  connect(&m_debounceTimer, &QTimer::timeout, this, &SearchIndex::evaluate);
+  connect(m_model, &QAbstractItemModel::rowsInserted, this, &SearchIndex::rowsInserted);
+  connect(m_model, &QAbstractItemModel::rowsRemoved, this, &SearchIndex::rowsRemoved);
+  connect(m_model, &QAbstractItemModel::dataChanged, this, &SearchIndex::dataChanged);
+  connect(m_model, &QAbstractItemModel::modelReset, this, &SearchIndex::loadKeys);
+  connect(m_model, &QAbstractItemModel::layoutChanged, this, &SearchIndex::loadKeys);
+  loadKeys();
+}
+
+SearchIndex::~SearchIndex() {
+  ++*m_request;
+  m_pool.waitForDone();
+}
+
+void SearchIndex::setQuery(const QString& _query) {
+  const QString query = _query.toCaseFolded();
+  if (query == m_query) {
+    return;
+  }
+
+  m_query = query;
+  ++*m_request;
+  if (m_query.isEmpty()) {
+    // nothing to scan for, everything shows at once
+    m_debounceTimer.stop();
+    m_matchesQuery.clear();
+    m_matches.fill(true);
+    Q_EMIT matchesChangedSignal();
+    return;
+  }
+
+  m_debounceTimer.start();
+}
+
+bool SearchIndex::isMatch(int _row) const {
+  return _row < 0 || _row >= m_matches.size() || m_matches[_row];
+}
+
+void SearchIndex::rebuild() {
+  loadKeys();
+  if (!m_matchesQuery.isEmpty()) {
+    Q_EMIT matchesChangedSignal();
+  }
+}
+
+void SearchIndex::loadKeys() {
+  const int rowCount = m_model->rowCount();
+  m_keys.resize(rowCount);
+  m_matches.resize(rowCount);
+  for (int row = 0; row < rowCount; ++row) {
+    m_keys[row] = m_keyFunction(row).toCaseFolded();
+    m_matches[row] = m_keys[row].contains(m_matchesQuery);
+  }
+
+  ++m_generation;
+}
+
+void SearchIndex::rowsInserted(const QModelIndex& _parent, int _first, int _last) {
+  if (_parent.isValid()) {
+    return;
+  }
+
+  const int count = _last - _first + 1;
+  m_keys.insert(_first, count, QString());
+  m_matches.insert(_first, count, false);
+  for (int row = _first; row <= _last; ++row) {
+    m_keys[row] = m_keyFunction(row).toCaseFolded();
+    m_matches[row] = m_keys[row].contains(m_matchesQuery);
+  }
+
+  ++m_generation;
+}
+
+void SearchIndex::rowsRemoved(const QModelIndex& _parent, int _first, int _last) {
+  if (_parent.isValid()) {
+    return;
+  }
+
+  m_keys.remove(_first, _last - _first + 1);
+  m_matches.remove(_first, _last - _first + 1);
+  ++m_generation;
+}
+
+void SearchIndex::dataChanged(const QModelIndex& _topLeft, const QModelIndex& _bottomRight) {
+  bool isChanged = false;
+  for (int row = _topLeft.row(); row <= _bottomRight.row() && row < m_keys.size(); ++row) {
+    const QString key = m_keyFunction(row).toCaseFolded();
+    if (key != m_keys[row]) {
+      m_keys[row] = key;
+      m_matches[row] = key.contains(m_matchesQuery);
+      isChanged = true;
+    }
+  }
+
+  // most changes, like confirmations counting up, leave the searched text alone
+  if (isChanged) {
+    ++m_generation;
+  }
+}
+
+void SearchIndex::evaluate() {
+  // a running scan calls back here when it is done
+  if (m_isEvaluating || m_query == m_matchesQuery) {
+    return;
+  }
+
+  m_isEvaluating = true;
+  const quint64 request = *m_request;
+  const quint64 generation = m_generation;
+  const QString query = m_query;
+  const QVector<QString> keys = m_keys;
+  // typing on narrows the last result, rows it ruled out stay out
+  const bool isNarrowing = !m_matchesQuery.isEmpty() && query.contains(m_matchesQuery);
+  const QVector<bool> previous = m_matches;
+  const std::shared_ptr<std::atomic<quint64>> latestRequest = m_request;
+  m_pool.start([this, request, generation, query, keys, isNarrowing, previous, latestRequest]() {
+    QVector<bool> matches(keys.size(), false);
+    bool isCancelled = false;
+    for (int row = 0; row < keys.size(); ++row) {
+      if (row % CANCEL_CHECK_ROWS == 0 && *latestRequest != request) {
+        isCancelled = true;
+        break;
+      }
+
+      matches[row] = (!isNarrowing || previous[row]) && keys[row].contains(query);
+    }
+
+    QMetaObject::invokeMethod(this, [this, generation, query, matches, isCancelled]() {
+      evaluationFinished(generation, query, matches, isCancelled);
+    }, Qt::QueuedConnection);
+  });
+}
+
+void SearchIndex::evaluationFinished(quint64 _generation, const QString& _query, const QVector<bool>& _matches, bool _isCancelled) {
+  m_isEvaluating = false;
+  if (!_isCancelled && _generation == m_generation && _query == m_query) {
+    m_matches = _matches;
+    m_matchesQuery = _query;
+    Q_EMIT matchesChangedSignal();
+    return;
+  }
+
+  // the query or the keys moved on while scanning
+  if (!m_debounceTimer.isActive()) {
+    evaluate();
+  }
+}
+
+}
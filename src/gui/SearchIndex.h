@@ -0,0 +1,68 @@
+// Copyright (c) 2016-2026 The Karbowanec developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <QAbstractItemModel>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVector>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+namespace WalletGui {
+
+// Case folded search keys of every row of a source model, kept in step with
+// its inserts, removals and changes. A new query is scanned for on a worker
+// thread once typing pauses; until then the previous result stays in effect.
+// Filter proxies answer filterAcceptsRow() from isMatch().
+class SearchIndex : public QObject {
+  Q_OBJECT
+  Q_DISABLE_COPY(SearchIndex)
+
+public:
+  typedef std::function<QString(int _row)> KeyFunction;
+
+  // create it before the proxy sets _model as its source, so the keys are updated before the proxy filters
+  SearchIndex(QAbstractItemModel* _model, KeyFunction _keyFunction, QObject* _parent = nullptr);
+  ~SearchIndex();
+
+  void setQuery(const QString& _query);
+  bool isMatch(int _row) const;
+  // for keys that depend on more than the model, e.g. address book labels
+  void rebuild();
+
+Q_SIGNALS:
+  void matchesChangedSignal();
+
+private:
+  QAbstractItemModel* m_model;
+  KeyFunction m_keyFunction;
+  QVector<QString> m_keys;
+  // whether every key contains m_matchesQuery
+  QVector<bool> m_matches;
+  QString m_matchesQuery;
+  QString m_query;
+  // bumped on every change of the keys, a result scanned from older keys is dropped
+  quint64 m_generation;
+  // bumped on every change of the query, a running scan gives up when it sees it
+  std::shared_ptr<std::atomic<quint64>> m_request;
+  bool m_isEvaluating;
+  QTimer m_debounceTimer;
+  // a single worker, destroyed first so no scan outlives the index
+  QThreadPool m_pool;
+
+  void loadKeys();
+  void rowsInserted(const QModelIndex& _parent, int _first, int _last);
+  void rowsRemoved(const QModelIndex& _parent, int _first, int _last);
+  void dataChanged(const QModelIndex& _topLeft, const QModelIndex& _bottomRight);
+  void evaluate();
+  void evaluationFinished(quint64 _generation, const QString& _query, const QVector<bool>& _matches, bool _isCancelled);
+};
+
+}
@@ -359,8 +359,10 @@ void SendFrame::sendClicked() {
     walletTransfer.amount = amount;
     walletTransfers.push_back(walletTransfer);
     QString label = transfer->getLabel();
-    if (!label.isEmpty()) {
-      AddressBookModel::instance().addAddress(label, address, m_ui->m_paymentIdEdit->text().toUtf8());
+    const QString paymentId = m_ui->m_paymentIdEdit->text();
+    const QModelIndex contact = AddressBookModel::instance().indexFromAddress(address, paymentId);
+    if (!label.isEmpty() && (!contact.isValid() || contact.data(AddressBookModel::ROLE_LABEL).toString() != label)) {
+      AddressBookModel::instance().addAddress(label, address, paymentId);
     }
   }
 
@@ -5,18 +5,34 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <QDateTime>
+#include <QStringList>
 
 #include "SortedOutputsModel.h"
 #include "OutputsModel.h"
 
 namespace WalletGui {
 
+namespace {
+
+QString outputSearchKey(int _row) {
+  QStringList fields;
+  for (int column = OutputsModel::COLUMN_OUTPUT_KEY; column <= OutputsModel::COLUMN_GLOBAL_OUTPUT_INDEX; ++column) {
+    fields.append(OutputsModel::instance().index(_row, column).data().toString());
+  }
+
+  return fields.join('\n');
+}
+
+}
+
 SortedOutputsModel& SortedOutputsModel::instance() {
   static SortedOutputsModel inst;
   return inst;
 }
 
-SortedOutputsModel::SortedOutputsModel() : QSortFilterProxyModel() {
+SortedOutputsModel::SortedOutputsModel() : QSortFilterProxyModel(),
+  m_searchIndex(&OutputsModel::instance(), outputSearchKey) {
+  connect(&m_searchIndex, &SearchIndex::matchesChangedSignal, this, [this]() { invalidateFilter(); });
   setSourceModel(&OutputsModel::instance());
   setDynamicSortFilter(true);
   sort(OutputsModel::COLUMN_GLOBAL_OUTPUT_INDEX, Qt::DescendingOrder);
@@ -26,6 +42,10 @@ SortedOutputsModel::~SortedOutputsModel() {
 }
 
 bool SortedOutputsModel::filterAcceptsRow(int _row, const QModelIndex &_parent) const {
+  if (!m_searchIndex.isMatch(_row)) {
+    return false;
+  }
+
   QModelIndex _index = sourceModel()->index(_row, 0, _parent);
 
   int state = _index.data(OutputsModel::ROLE_STATE).value<quint8>();
@@ -35,18 +55,11 @@ bool SortedOutputsModel::filterAcceptsRow(int _row, const QModelIndex &_parent)
       return false;
   }
 
-  return (sourceModel()->data(sourceModel()->index(_row, 2, _parent)).toString().contains(m_searchString,Qt::CaseInsensitive)
-       || sourceModel()->data(sourceModel()->index(_row, 3, _parent)).toString().contains(m_searchString,Qt::CaseInsensitive)
-       || sourceModel()->data(sourceModel()->index(_row, 4, _parent)).toString().contains(m_searchString,Qt::CaseInsensitive)
-       || sourceModel()->data(sourceModel()->index(_row, 5, _parent)).toString().contains(m_searchString,Qt::CaseInsensitive)
-  );
-
   return true;
 }
 
 void SortedOutputsModel::setSearchFor(const QString &searchString) {
-  this->m_searchString = searchString;
-  invalidateFilter();
+  m_searchIndex.setQuery(searchString);
 }
 
 void SortedOutputsModel::setState(const int state) {
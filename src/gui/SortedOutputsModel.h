@@ -8,6 +8,8 @@
 
 #include <QSortFilterProxyModel>
 
+#include "SearchIndex.h"
+
 namespace WalletGui {
 
 class SortedOutputsModel : public QSortFilterProxyModel {
@@ -27,7 +29,8 @@ private:
   SortedOutputsModel();
   ~SortedOutputsModel();
 
-  QString m_searchString;
+  // output key, transaction hash, amount and global index of every row
+  SearchIndex m_searchIndex;
   int m_selectedState = -1;
 
 };
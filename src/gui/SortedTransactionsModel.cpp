@@ -4,13 +4,28 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <QDateTime>
+#include <QStringList>
 
 #include "SortedTransactionsModel.h"
+#include "AddressBookModel.h"
 #include "TransactionsModel.h"
 #include "Settings.h"
 
 namespace WalletGui {
 
+namespace {
+
+QString transactionSearchKey(int _row) {
+  QStringList fields;
+  for (int column = TransactionsModel::COLUMN_AMOUNT; column <= TransactionsModel::COLUMN_HASH; ++column) {
+    fields.append(TransactionsModel::instance().index(_row, column).data().toString());
+  }
+
+  return fields.join('\n');
+}
+
+}
+
 SortedTransactionsModel& SortedTransactionsModel::instance() {
   static SortedTransactionsModel inst;
   return inst;
@@ -21,7 +36,13 @@ const QDateTime SortedTransactionsModel::MIN_DATE = QDateTime::fromSecsSinceEpoc
 // Last date that can be represented (far in the future)
 const QDateTime SortedTransactionsModel::MAX_DATE = QDateTime::fromSecsSinceEpoch(0xFFFFFFFF);
 
-SortedTransactionsModel::SortedTransactionsModel() : QSortFilterProxyModel() {
+SortedTransactionsModel::SortedTransactionsModel() : QSortFilterProxyModel(),
+  m_searchIndex(&TransactionsModel::instance(), transactionSearchKey) {
+  connect(&m_searchIndex, &SearchIndex::matchesChangedSignal, this, [this]() { invalidateFilter(); });
+  // the address column shows the contact label as well
+  connect(&AddressBookModel::instance(), &QAbstractItemModel::rowsInserted, &m_searchIndex, &SearchIndex::rebuild);
+  connect(&AddressBookModel::instance(), &QAbstractItemModel::rowsRemoved, &m_searchIndex, &SearchIndex::rebuild);
+  connect(&AddressBookModel::instance(), &QAbstractItemModel::modelReset, &m_searchIndex, &SearchIndex::rebuild);
   setSourceModel(&TransactionsModel::instance());
   setDynamicSortFilter(true);
   sort(TransactionsModel::COLUMN_DATE, Qt::DescendingOrder);
@@ -31,6 +52,10 @@ SortedTransactionsModel::~SortedTransactionsModel() {
 }
 
 bool SortedTransactionsModel::filterAcceptsRow(int _row, const QModelIndex &_parent) const {
+  if (!m_searchIndex.isMatch(_row)) {
+    return false;
+  }
+
   QModelIndex _index = sourceModel()->index(_row, 0, _parent);
 
   QDateTime datetime = _index.data(TransactionsModel::ROLE_DATE).toDateTime();
@@ -45,18 +70,6 @@ bool SortedTransactionsModel::filterAcceptsRow(int _row, const QModelIndex &_par
       return false;
   }
 
-  QModelIndex index2 = sourceModel()->index(_row, 2, _parent);
-  QModelIndex index3 = sourceModel()->index(_row, 3, _parent);
-  QModelIndex index4 = sourceModel()->index(_row, 4, _parent);
-  QModelIndex index5 = sourceModel()->index(_row, 5, _parent);
-  QModelIndex index6 = sourceModel()->index(_row, 6, _parent);
-
-  return (sourceModel()->data(index2).toString().contains(searchstring,Qt::CaseInsensitive)
-       || sourceModel()->data(index3).toString().contains(searchstring,Qt::CaseInsensitive)
-       || sourceModel()->data(index4).toString().contains(searchstring,Qt::CaseInsensitive)
-       || sourceModel()->data(index5).toString().contains(searchstring,Qt::CaseInsensitive)
-       || sourceModel()->data(index6).toString().contains(searchstring,Qt::CaseInsensitive));
-
   return true;
  }
 
@@ -86,8 +99,7 @@ void SortedTransactionsModel::setDateRange(const QDateTime &from, const QDateTim
 }
 
 void SortedTransactionsModel::setSearchFor(const QString &searchstring) {
-    this->searchstring = searchstring;
-    invalidateFilter();
+    m_searchIndex.setQuery(searchstring);
 }
 
 void SortedTransactionsModel::setTxType(const int type) {
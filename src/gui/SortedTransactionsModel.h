@@ -8,6 +8,8 @@
 #include <QDateTime>
 #include <QSortFilterProxyModel>
 
+#include "SearchIndex.h"
+
 namespace WalletGui {
 
 class SortedTransactionsModel : public QSortFilterProxyModel {
@@ -35,9 +37,10 @@ private:
 
   bool dateInRange(const QDate &date) const;
 
+  // amount, fee, address, payment ID and hash of every row
+  SearchIndex m_searchIndex;
   QDateTime dateFrom = MIN_DATE;
   QDateTime dateTo = MAX_DATE;
-  QString searchstring;
   int selectedtxtype = -1;
 
 };
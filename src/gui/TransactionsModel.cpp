@@ -11,6 +11,7 @@
 #include <QPixmapCache>
 
 #include "crypto/crypto.h"
+#include "CryptoNoteConfig.h"
 #include "CryptoNoteCore/CryptoNoteBasic.h"
 #include "CurrencyAdapter.h"
 #include "NodeAdapter.h"
@@ -22,6 +23,10 @@ namespace WalletGui {
 
 namespace {
 
+// the state icon steps through the first confirmations and mined rows stay locked until the unlock
+// window passes; past both a row only counts up, which changes neither its icon nor its sort order
+const quint64 SETTLED_CONFIRMATIONS = qMax<quint64>(7, CryptoNote::parameters::CRYPTONOTE_MINED_MONEY_UNLOCK_WINDOW);
+
 QPixmap renderSvgIcon(const QString& _path, const QSize& _size) {
   QString cacheKey = _path + QString("_%1x%2").arg(_size.width()).arg(_size.height());
   QPixmap pixmap;
@@ -131,18 +136,7 @@ QVariant TransactionsModel::headerData(int _section, Qt::Orientation _orientatio
 }
 
 QVariant TransactionsModel::data(const QModelIndex& _index, int _role) const {
-  if(!_index.isValid()) {
-    return QVariant();
-  }
-
-  CryptoNote::WalletLegacyTransaction transaction;
-  CryptoNote::WalletLegacyTransfer transfer;
-  CryptoNote::TransactionId transactionId = m_transfers.value(_index.row()).first;
-  CryptoNote::TransferId transferId = m_transfers.value(_index.row()).second;
-
-  if(!WalletAdapter::instance().getTransaction(transactionId, transaction) ||
-    (m_transfers.value(_index.row()).second != CryptoNote::WALLET_LEGACY_INVALID_TRANSFER_ID &&
-    !WalletAdapter::instance().getTransfer(transferId, transfer))) {
+  if(!_index.isValid() || _index.row() >= m_transfers.size()) {
     return QVariant();
   }
 
@@ -163,7 +157,7 @@ QVariant TransactionsModel::data(const QModelIndex& _index, int _role) const {
     return getToolTipRole(_index);
 
   default:
-    return getUserRole(_index, _role, transactionId, transaction, transferId, transfer);
+    return getUserRole(_index, _role);
   }
 
   return QVariant();
@@ -200,52 +194,43 @@ QByteArray TransactionsModel::toCsv() const {
 }
 
 QVariant TransactionsModel::getDisplayRole(const QModelIndex& _index) const {
+  const int row = _index.row();
   switch(_index.column()) {
-  case COLUMN_DATE: {
-    QDateTime date = _index.data(ROLE_DATE).toDateTime();
-    return (date.isNull() || !date.isValid() ? "-" : date.toString("dd.MM.yy HH:mm"));
-  }
+  case COLUMN_DATE:
+    return m_rows.dateText[row];
 
   case COLUMN_HASH:
-    return _index.data(ROLE_HASH).toByteArray().toHex().toUpper();
+    return m_rows.hash[row].toHex().toUpper();
 
   case COLUMN_SECRET_KEY:
-    return _index.data(ROLE_SECRET_KEY).toByteArray().toHex().toUpper();
+    return m_rows.secretKey[row].toHex().toUpper();
 
   case COLUMN_ADDRESS: {
-    TransactionType transactionType = static_cast<TransactionType>(_index.data(ROLE_TYPE).value<quint8>());
-    QString transactionAddress = _index.data(ROLE_ADDRESS).toString();
-    if (transactionType == TransactionType::INPUT || transactionType == TransactionType::MINED ||
-        transactionType == TransactionType::INOUT) {
-      return QString(tr("me (%1)").arg(WalletAdapter::instance().getAddress()));
-    } else if (transactionAddress.isEmpty()) {
-      return tr("(n/a)");
+    const TransactionType transactionType = static_cast<TransactionType>(m_rows.type[row]);
+    if (transactionType != TransactionType::OUTPUT || m_rows.address[row].isEmpty()) {
+      return getAddressText(row);
     }
 
-    QModelIndex contactIndex = AddressBookModel::instance().indexFromContact(transactionAddress,1);
+    // the label may change at any time, so it is looked up rather than cached
+    QModelIndex contactIndex = AddressBookModel::instance().indexFromContact(m_rows.address[row], 1);
     QString Contact = contactIndex.data(AddressBookModel::ROLE_LABEL).toString();
     if(!Contact.isEmpty())
-      return QString("%1 (%2)").arg(Contact, transactionAddress);
+      return QString("%1 (%2)").arg(Contact, m_rows.address[row]);
 
-    return transactionAddress;
+    return m_rows.address[row];
   }
 
-  case COLUMN_AMOUNT: {
-    qint64 amount = _index.data(ROLE_AMOUNT).value<qint64>();
-    QString amountStr = CurrencyAdapter::instance().formatAmount(qAbs(amount)).remove(',');
-    return (amount < 0 ? "-" + amountStr : amountStr);
-  }
+  case COLUMN_AMOUNT:
+    return m_rows.amountText[row];
 
   case COLUMN_PAYMENT_ID:
-    return _index.data(ROLE_PAYMENT_ID);
+    return m_rows.paymentId[row];
 
-  case COLUMN_FEE: {
-    qint64 fee = _index.data(ROLE_FEE).value<qint64>();
-    return CurrencyAdapter::instance().formatAmount(fee);
-  }
+  case COLUMN_FEE:
+    return m_rows.feeText[row];
 
   case COLUMN_HEIGHT:
-    return QString::number(_index.data(ROLE_HEIGHT).value<quint64>());
+    return QString::number(m_rows.height[row]);
 
   default:
     break;
@@ -255,56 +240,35 @@ QVariant TransactionsModel::getDisplayRole(const QModelIndex& _index) const {
 }
 
 QVariant TransactionsModel::getEditRole(const QModelIndex& _index) const {
+  const int row = _index.row();
   switch(_index.column()) {
 
-  case COLUMN_STATE: {
-    quint64 numberOfConfirmations = _index.data(ROLE_NUMBER_OF_CONFIRMATIONS).value<quint64>();
-    return numberOfConfirmations;
-  }
+  case COLUMN_STATE:
+    return getNumberOfConfirmations(row);
 
-  case COLUMN_DATE: {
-    QDateTime date = _index.data(ROLE_DATE).toDateTime();
-    return (date);
-  }
+  case COLUMN_DATE:
+    return (m_rows.timestamp[row] > 0 ? QDateTime::fromSecsSinceEpoch(m_rows.timestamp[row]) : QDateTime());
 
   case COLUMN_HASH:
-    return _index.data(ROLE_HASH).toByteArray().toHex().toUpper();
+    return m_rows.hash[row].toHex().toUpper();
 
   case COLUMN_SECRET_KEY:
-    return _index.data(ROLE_SECRET_KEY).toByteArray().toHex().toUpper();
+    return m_rows.secretKey[row].toHex().toUpper();
 
-  case COLUMN_ADDRESS: {
-    TransactionType transactionType = static_cast<TransactionType>(_index.data(ROLE_TYPE).value<quint8>());
-    QString transactionAddress = _index.data(ROLE_ADDRESS).toString();
-    if (transactionType == TransactionType::INPUT || transactionType == TransactionType::MINED ||
-        transactionType == TransactionType::INOUT) {
-      return QString(tr("me (%1)").arg(WalletAdapter::instance().getAddress()));
-    } else if (transactionAddress.isEmpty()) {
-      return tr("(n/a)");
-    }
+  case COLUMN_ADDRESS:
+    return getAddressText(row);
 
-    return transactionAddress;
-  }
-
-  case COLUMN_AMOUNT: {
-    qint64 amount = _index.data(ROLE_AMOUNT).value<qint64>();
-    QString amountStr = CurrencyAdapter::instance().formatAmount(qAbs(amount)).remove(',');
-    if (amount < 0) {
-      amountStr.insert(0, "-");
-    }
-    return (amountStr.toDouble());
-  }
+  case COLUMN_AMOUNT:
+    return m_rows.amountText[row].toDouble();
 
   case COLUMN_PAYMENT_ID:
-    return _index.data(ROLE_PAYMENT_ID);
+    return m_rows.paymentId[row];
 
-  case COLUMN_FEE: {
-    qint64 fee = _index.data(ROLE_FEE).value<qint64>();
-    return CurrencyAdapter::instance().formatAmount(fee);
-  }
+  case COLUMN_FEE:
+    return m_rows.feeText[row];
 
   case COLUMN_HEIGHT:
-    return QString::number(_index.data(ROLE_HEIGHT).value<quint64>());
+    return QString::number(m_rows.height[row]);
 
   default:
     break;
@@ -313,10 +277,34 @@ QVariant TransactionsModel::getEditRole(const QModelIndex& _index) const {
   return QVariant();
 }
 
+QString TransactionsModel::getAddressText(int _row) const {
+  const TransactionType transactionType = static_cast<TransactionType>(m_rows.type[_row]);
+  if (transactionType == TransactionType::INPUT || transactionType == TransactionType::MINED ||
+      transactionType == TransactionType::INOUT) {
+    return QString(tr("me (%1)").arg(WalletAdapter::instance().getAddress()));
+  } else if (m_rows.address[_row].isEmpty()) {
+    return tr("(n/a)");
+  }
+
+  return m_rows.address[_row];
+}
+
+quint64 TransactionsModel::getNumberOfConfirmations(int _row) const {
+  const quint32 height = m_rows.height[_row];
+  return (height == CryptoNote::WALLET_LEGACY_UNCONFIRMED_TRANSACTION_HEIGHT ? 0 :
+    NodeAdapter::instance().getLastKnownBlockHeight() - height + 1);
+}
+
+bool TransactionsModel::isSettled(int _row) const {
+  const TransactionState state = static_cast<TransactionState>(m_rows.state[_row]);
+  return (state != TransactionState::ACTIVE && state != TransactionState::SENDING) ||
+    getNumberOfConfirmations(_row) >= SETTLED_CONFIRMATIONS;
+}
+
 QVariant TransactionsModel::getToolTipRole(const QModelIndex& _index) const {
-  quint64 numberOfConfirmations = _index.data(ROLE_NUMBER_OF_CONFIRMATIONS).value<quint64>();
-  TransactionType transactionType = static_cast<TransactionType>(_index.data(ROLE_TYPE).value<quint8>());
-  TransactionState transactionState = static_cast<TransactionState>(_index.data(ROLE_STATE).value<quint8>());
+  quint64 numberOfConfirmations = getNumberOfConfirmations(_index.row());
+  TransactionType transactionType = static_cast<TransactionType>(m_rows.type[_index.row()]);
+  TransactionState transactionState = static_cast<TransactionState>(m_rows.state[_index.row()]);
   if (transactionState != TransactionState::ACTIVE && transactionState != TransactionState::SENDING) {
     return QString(tr("Canceled or failed transaction"));
   } else if (numberOfConfirmations == 0) {
@@ -349,8 +337,8 @@ QVariant TransactionsModel::getToolTipRole(const QModelIndex& _index) const {
 
 QVariant TransactionsModel::getDecorationRole(const QModelIndex& _index) const {
   if(_index.column() == COLUMN_STATE) {
-    quint64 numberOfConfirmations = _index.data(ROLE_NUMBER_OF_CONFIRMATIONS).value<quint64>();
-    TransactionState transactionState = static_cast<TransactionState>(_index.data(ROLE_STATE).value<quint8>());
+    quint64 numberOfConfirmations = getNumberOfConfirmations(_index.row());
+    TransactionState transactionState = static_cast<TransactionState>(m_rows.state[_index.row()]);
     QString file;
     if (transactionState != TransactionState::ACTIVE && transactionState != TransactionState::SENDING) {
       file = QString(":icons/cancelled");
@@ -372,7 +360,7 @@ QVariant TransactionsModel::getDecorationRole(const QModelIndex& _index) const {
     return renderSvgIcon(file, QSize(16, 16));
 
   } else if (_index.column() == COLUMN_ADDRESS) {
-    return _index.data(ROLE_ICON).value<QPixmap>();
+    return getTransactionIcon(static_cast<TransactionType>(m_rows.type[_index.row()]), QSize(20, 20));
   }
 
   return QVariant();
@@ -382,66 +370,47 @@ QVariant TransactionsModel::getAlignmentRole(const QModelIndex& _index) const {
   return headerData(_index.column(), Qt::Horizontal, Qt::TextAlignmentRole);
 }
 
-QVariant TransactionsModel::getUserRole(const QModelIndex& _index, int _role, CryptoNote::TransactionId _transactionId,
-  CryptoNote::WalletLegacyTransaction& _transaction, CryptoNote::TransferId _transferId, CryptoNote::WalletLegacyTransfer& _transfer) const {
+QVariant TransactionsModel::getUserRole(const QModelIndex& _index, int _role) const {
+  const int row = _index.row();
   switch(_role) {
   case ROLE_STATE:
-    return static_cast<quint8>(_transaction.state);
+    return m_rows.state[row];
 
   case ROLE_DATE:
-    return (_transaction.timestamp > 0 ? QDateTime::fromSecsSinceEpoch(_transaction.timestamp) : QDateTime());
-
-  case ROLE_TYPE: {
-    QString transactionAddress = _index.data(ROLE_ADDRESS).toString();
-    if(_transaction.isCoinbase) {
-      return static_cast<quint8>(TransactionType::MINED);
-    } else if (!transactionAddress.compare(WalletAdapter::instance().getAddress())) {
-      return static_cast<quint8>(TransactionType::INOUT);
-    } else if (_transaction.totalAmount < 0) {
-      return static_cast<quint8>(TransactionType::OUTPUT);
-    }
+    return (m_rows.timestamp[row] > 0 ? QDateTime::fromSecsSinceEpoch(m_rows.timestamp[row]) : QDateTime());
 
-    return static_cast<quint8>(TransactionType::INPUT);
-  }
+  case ROLE_TYPE:
+    return m_rows.type[row];
 
   case ROLE_HASH:
-    return QByteArray(reinterpret_cast<char*>(&_transaction.hash), sizeof(_transaction.hash));
+    return m_rows.hash[row];
 
-  case ROLE_SECRET_KEY: {
-    if (_transaction.secretKey) {
-      Crypto::SecretKey txkey = _transaction.secretKey.get();
-      if (txkey != CryptoNote::NULL_SECRET_KEY) {
-        return QByteArray(reinterpret_cast<char*>(&txkey), sizeof(txkey));
-      }
-    }
-  }
+  case ROLE_SECRET_KEY:
+    return m_rows.secretKey[row];
 
   case ROLE_ADDRESS:
-    return QString::fromStdString(_transfer.address);
+    return m_rows.address[row];
 
   case ROLE_AMOUNT:
-    return static_cast<qint64>(_transferId == CryptoNote::WALLET_LEGACY_INVALID_TRANSFER_ID ? _transaction.totalAmount : -_transfer.amount);
+    return m_rows.amount[row];
 
   case ROLE_PAYMENT_ID:
-    return NodeAdapter::instance().extractPaymentId(_transaction.extra);
+    return m_rows.paymentId[row];
 
-  case ROLE_ICON: {
-    TransactionType transactionType = static_cast<TransactionType>(_index.data(ROLE_TYPE).value<quint8>());
-    return getTransactionIcon(transactionType, QSize(20, 20));
-  }
+  case ROLE_ICON:
+    return getTransactionIcon(static_cast<TransactionType>(m_rows.type[row]), QSize(20, 20));
 
   case ROLE_TRANSACTION_ID:
-    return QVariant::fromValue(_transactionId);
+    return QVariant::fromValue(m_transfers[row].first);
 
   case ROLE_HEIGHT:
-    return static_cast<quint64>(_transaction.blockHeight);
+    return static_cast<quint64>(m_rows.height[row]);
 
   case ROLE_FEE:
-    return static_cast<quint64>(_transaction.fee);
+    return m_rows.fee[row];
 
   case ROLE_NUMBER_OF_CONFIRMATIONS:
-    return (_transaction.blockHeight == CryptoNote::WALLET_LEGACY_UNCONFIRMED_TRANSACTION_HEIGHT ? 0 :
-      NodeAdapter::instance().getLastKnownBlockHeight() - _transaction.blockHeight + 1);
+    return getNumberOfConfirmations(row);
 
   case ROLE_COLUMN:
     return headerData(_index.column(), Qt::Horizontal, ROLE_COLUMN);
@@ -453,10 +422,91 @@ QVariant TransactionsModel::getUserRole(const QModelIndex& _index, int _role, Cr
   return QVariant();
 }
 
+void TransactionsModel::resizeRows(int _count) {
+  m_rows.state.resize(_count);
+  m_rows.type.resize(_count);
+  m_rows.timestamp.resize(_count);
+  m_rows.amount.resize(_count);
+  m_rows.fee.resize(_count);
+  m_rows.height.resize(_count);
+  m_rows.hash.resize(_count);
+  m_rows.secretKey.resize(_count);
+  m_rows.address.resize(_count);
+  m_rows.paymentId.resize(_count);
+  m_rows.dateText.resize(_count);
+  m_rows.amountText.resize(_count);
+  m_rows.feeText.resize(_count);
+}
+
+void TransactionsModel::decodeRow(int _row, const CryptoNote::WalletLegacyTransaction& _transaction, CryptoNote::TransferId _transferId,
+  const CryptoNote::WalletLegacyTransfer& _transfer) {
+  const QString address = QString::fromStdString(_transfer.address);
+  TransactionType type = TransactionType::INPUT;
+  if (_transaction.isCoinbase) {
+    type = TransactionType::MINED;
+  } else if (!address.compare(WalletAdapter::instance().getAddress())) {
+    type = TransactionType::INOUT;
+  } else if (_transaction.totalAmount < 0) {
+    type = TransactionType::OUTPUT;
+  }
+
+  const qint64 amount = static_cast<qint64>(_transferId == CryptoNote::WALLET_LEGACY_INVALID_TRANSFER_ID ? _transaction.totalAmount : -_transfer.amount);
+  const QString amountText = CurrencyAdapter::instance().formatAmount(qAbs(amount)).remove(',');
+
+  QByteArray secretKey;
+  if (_transaction.secretKey) {
+    Crypto::SecretKey txkey = _transaction.secretKey.get();
+    if (txkey != CryptoNote::NULL_SECRET_KEY) {
+      secretKey = QByteArray(reinterpret_cast<const char*>(&txkey), sizeof(txkey));
+    }
+  }
+
+  m_rows.state[_row] = static_cast<quint8>(_transaction.state);
+  m_rows.type[_row] = static_cast<quint8>(type);
+  m_rows.timestamp[_row] = _transaction.timestamp;
+  m_rows.amount[_row] = amount;
+  m_rows.fee[_row] = _transaction.fee;
+  m_rows.height[_row] = _transaction.blockHeight;
+  m_rows.hash[_row] = QByteArray(reinterpret_cast<const char*>(&_transaction.hash), sizeof(_transaction.hash));
+  m_rows.secretKey[_row] = secretKey;
+  m_rows.address[_row] = address;
+  m_rows.paymentId[_row] = NodeAdapter::instance().extractPaymentId(_transaction.extra);
+  m_rows.dateText[_row] = _transaction.timestamp > 0 ?
+    QDateTime::fromSecsSinceEpoch(_transaction.timestamp).toString("dd.MM.yy HH:mm") : QString("-");
+  m_rows.amountText[_row] = amount < 0 ? "-" + amountText : amountText;
+  m_rows.feeText[_row] = CurrencyAdapter::instance().formatAmount(_transaction.fee);
+  if (isSettled(_row)) {
+    m_unsettledRows.erase(_row);
+  } else {
+    m_unsettledRows.insert(_row);
+  }
+}
+
+void TransactionsModel::decodeTransaction(CryptoNote::TransactionId _id) {
+  CryptoNote::WalletLegacyTransaction transaction;
+  if (!m_transactionRow.contains(_id) || !WalletAdapter::instance().getTransaction(_id, transaction)) {
+    return;
+  }
+
+  const quint32 firstRow = m_transactionRow.value(_id).first;
+  const quint32 rowCount = m_transactionRow.value(_id).second;
+  for (quint32 row = firstRow; row < firstRow + rowCount; ++row) {
+    const CryptoNote::TransferId transferId = m_transfers[row].second;
+    CryptoNote::WalletLegacyTransfer transfer;
+    if (transferId != CryptoNote::WALLET_LEGACY_INVALID_TRANSFER_ID && !WalletAdapter::instance().getTransfer(transferId, transfer)) {
+      continue;
+    }
+
+    decodeRow(row, transaction, transferId, transfer);
+  }
+}
+
 void TransactionsModel::reloadWalletTransactions() {
   beginResetModel();
   m_transfers.clear();
   m_transactionRow.clear();
+  m_unsettledRows.clear();
+  resizeRows(0);
   endResetModel();
 
   quint32 row_count = 0;
@@ -478,12 +528,18 @@ void TransactionsModel::appendTransaction(CryptoNote::TransactionId _transaction
 
   if (transaction.transferCount) {
     m_transactionRow[_transactionId] = qMakePair(m_transfers.size(), transaction.transferCount);
+    resizeRows(m_transfers.size() + transaction.transferCount);
     for (CryptoNote::TransferId transfer_id = transaction.firstTransferId;
       transfer_id < transaction.firstTransferId + transaction.transferCount; ++transfer_id) {
+      CryptoNote::WalletLegacyTransfer transfer;
+      WalletAdapter::instance().getTransfer(transfer_id, transfer);
+      decodeRow(m_transfers.size(), transaction, transfer_id, transfer);
       m_transfers.append(TransactionTransferId(_transactionId, transfer_id));
       ++_insertedRowCount;
     }
   } else {
+    resizeRows(m_transfers.size() + 1);
+    decodeRow(m_transfers.size(), transaction, CryptoNote::WALLET_LEGACY_INVALID_TRANSFER_ID, CryptoNote::WalletLegacyTransfer());
     m_transfers.append(TransactionTransferId(_transactionId, CryptoNote::WALLET_LEGACY_INVALID_TRANSFER_ID));
     m_transactionRow[_transactionId] = qMakePair(m_transfers.size() - 1, 1);
     ++_insertedRowCount;
@@ -508,15 +564,42 @@ void TransactionsModel::appendTransaction(CryptoNote::TransactionId _transaction
 }
 
 void TransactionsModel::updateWalletTransaction(CryptoNote::TransactionId _id) {
+  if (!m_transactionRow.contains(_id)) {
+    return;
+  }
+
+  decodeTransaction(_id);
   quint32 firstRow = m_transactionRow.value(_id).first;
   quint32 lastRow = firstRow + m_transactionRow.value(_id).second - 1;
-  Q_EMIT dataChanged(index(firstRow, COLUMN_DATE), index(lastRow, COLUMN_DATE));
-  Q_EMIT dataChanged(index(firstRow, COLUMN_STATE), index(lastRow, COLUMN_STATE));
+  // any decoded field may have changed, e.g. the height and date once the transaction is mined
+  Q_EMIT dataChanged(index(firstRow, 0), index(lastRow, columnCount() - 1));
 }
 
 void TransactionsModel::localBlockchainUpdated(quint64 _height) {
-  if(rowCount() > 0) {
-    Q_EMIT dataChanged(index(0, COLUMN_STATE), index(rowCount() - 1, COLUMN_STATE));
+  Q_UNUSED(_height);
+  // only rows still inside the window are repainted, once more on the block that settles them
+  int firstRow = -1;
+  int lastRow = -1;
+  for (auto it = m_unsettledRows.begin(); it != m_unsettledRows.end(); ) {
+    const int row = static_cast<int>(*it);
+    if (firstRow < 0 || row != lastRow + 1) {
+      if (firstRow >= 0) {
+        Q_EMIT dataChanged(index(firstRow, COLUMN_STATE), index(lastRow, COLUMN_STATE));
+      }
+
+      firstRow = row;
+    }
+
+    lastRow = row;
+    if (isSettled(row)) {
+      it = m_unsettledRows.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  if (firstRow >= 0) {
+    Q_EMIT dataChanged(index(firstRow, COLUMN_STATE), index(lastRow, COLUMN_STATE));
   }
 }
 
@@ -524,6 +607,8 @@ void TransactionsModel::reset() {
   beginResetModel();
   m_transfers.clear();
   m_transactionRow.clear();
+  m_unsettledRows.clear();
+  resizeRows(0);
   endResetModel();
 }
 
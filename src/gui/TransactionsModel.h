@@ -8,6 +8,8 @@
 #include <QAbstractItemModel>
 #include <QSortFilterProxyModel>
 
+#include <set>
+
 #include <IWalletLegacy.h>
 
 namespace WalletGui {
@@ -50,8 +52,30 @@ public:
   void reloadWalletTransactions();
 
 private:
+  // decoded fields of every row, column by column, filled when a transaction is
+  // appended and refreshed when the wallet reports it updated
+  struct RowCache {
+    QVector<quint8> state;
+    QVector<quint8> type;
+    QVector<quint64> timestamp;
+    QVector<qint64> amount;
+    QVector<quint64> fee;
+    // base of the confirmation count
+    QVector<quint32> height;
+    QVector<QByteArray> hash;
+    QVector<QByteArray> secretKey;
+    QVector<QString> address;
+    QVector<QString> paymentId;
+    QVector<QString> dateText;
+    QVector<QString> amountText;
+    QVector<QString> feeText;
+  };
+
   QVector<TransactionTransferId> m_transfers;
   QHash<CryptoNote::TransactionId, QPair<quint32, quint32> > m_transactionRow;
+  RowCache m_rows;
+  // rows whose confirmation count still changes what is shown, in row order
+  std::set<quint32> m_unsettledRows;
 
   TransactionsModel();
   ~TransactionsModel();
@@ -61,9 +85,15 @@ private:
   QVariant getDecorationRole(const QModelIndex& _index) const;
   QVariant getAlignmentRole(const QModelIndex& _index) const;
   QVariant getToolTipRole(const QModelIndex& _index) const;
-  QVariant getUserRole(const QModelIndex& _index, int _role, CryptoNote::TransactionId _transactionId, CryptoNote::WalletLegacyTransaction& _transaction,
-    CryptoNote::TransferId _transferId, CryptoNote::WalletLegacyTransfer& _transfer) const;
-
+  QVariant getUserRole(const QModelIndex& _index, int _role) const;
+  QString getAddressText(int _row) const;
+  quint64 getNumberOfConfirmations(int _row) const;
+  bool isSettled(int _row) const;
+
+  void resizeRows(int _count);
+  void decodeRow(int _row, const CryptoNote::WalletLegacyTransaction& _transaction, CryptoNote::TransferId _transferId,
+    const CryptoNote::WalletLegacyTransfer& _transfer);
+  void decodeTransaction(CryptoNote::TransactionId _id);
   void appendTransaction(CryptoNote::TransactionId _id, quint32& _row_count);
   void appendTransaction(CryptoNote::TransactionId _id);
   void updateWalletTransaction(CryptoNote::TransactionId _id);
@@ -0,0 +1,127 @@
+// Copyright (c) 2016-2026 The Karbowanec developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// Checks of OutputIndex built from synthetic output vectors: the unlocked
+// set as unspent minus locked, the unlocked amount histogram and the totals.
+// Run by ctest; exits with a non-zero status when a check fails.
+
+#include <cstring>
+#include <vector>
+
+#include "OutputIndex.h"
+#include "TestCheck.h"
+
+using namespace WalletGui;
+using WalletGui::Tests::check;
+
+namespace {
+
+CryptoNote::TransactionOutputInformation makeOutput(uint8_t _transaction, uint32_t _index, uint64_t _amount) {
+  CryptoNote::TransactionOutputInformation output = CryptoNote::TransactionOutputInformation();
+  std::memset(&output.transactionHash, _transaction, sizeof(output.transactionHash));
+  output.outputInTransaction = _index;
+  output.amount = _amount;
+  return output;
+}
+
+CryptoNote::TransactionSpentOutputInformation makeSpentOutput(uint8_t _transaction, uint32_t _index, uint64_t _amount) {
+  CryptoNote::TransactionSpentOutputInformation output = CryptoNote::TransactionSpentOutputInformation();
+  static_cast<CryptoNote::TransactionOutputInformation&>(output) = makeOutput(_transaction, _index, _amount);
+  return output;
+}
+
+bool isSameOutput(const CryptoNote::TransactionOutputInformation& _left, const CryptoNote::TransactionOutputInformation& _right) {
+  return std::memcmp(&_left.transactionHash, &_right.transactionHash, sizeof(_left.transactionHash)) == 0 &&
+    _left.outputInTransaction == _right.outputInTransaction && _left.amount == _right.amount;
+}
+
+void testEmpty() {
+  const OutputIndex index;
+  check(index.unspent().empty() && index.unlocked().empty() && index.locked().empty() && index.spent().empty(),
+    "a default index has no outputs");
+  check(index.unlockedAmounts().empty(), "a default index has an empty histogram");
+  check(index.unlockedAmount() == 0 && index.lockedAmount() == 0 && index.spentAmount() == 0,
+    "a default index has zero totals");
+}
+
+void testUnlockedSplit() {
+  std::vector<CryptoNote::TransactionOutputInformation> unspent = {
+    makeOutput(1, 0, 100),
+    makeOutput(1, 1, 200),
+    makeOutput(2, 0, 100),
+    makeOutput(3, 0, 5000),
+    makeOutput(4, 1, 30)
+  };
+
+  std::vector<CryptoNote::TransactionOutputInformation> locked = {
+    // matched by transaction hash and index, not by amount
+    makeOutput(3, 0, 5000),
+    makeOutput(1, 1, 200)
+  };
+
+  std::vector<CryptoNote::TransactionSpentOutputInformation> spent = {
+    makeSpentOutput(5, 0, 300),
+    makeSpentOutput(6, 2, 40)
+  };
+
+  const OutputIndex index(std::move(unspent), std::move(locked), std::move(spent));
+  check(index.unspent().size() == 5, "unspent keeps every output the wallet reports");
+  check(index.locked().size() == 2, "locked keeps every locked output");
+  check(index.spent().size() == 2, "spent keeps every spent output");
+
+  const std::vector<CryptoNote::TransactionOutputInformation>& unlocked = index.unlocked();
+  check(unlocked.size() == 3, "unlocked is unspent minus locked");
+  if (unlocked.size() == 3) {
+    check(isSameOutput(unlocked[0], makeOutput(1, 0, 100)), "same transaction, other index stays unlocked");
+    check(isSameOutput(unlocked[1], makeOutput(2, 0, 100)), "other transaction, same index stays unlocked");
+    check(isSameOutput(unlocked[2], makeOutput(4, 1, 30)), "unlocked keeps the wallet order");
+  }
+
+  const std::map<uint64_t, size_t>& amounts = index.unlockedAmounts();
+  check(amounts.size() == 2, "histogram has one entry per unlocked amount");
+  check(amounts.count(100) == 1 && amounts.at(100) == 2, "histogram counts repeated amounts");
+  check(amounts.count(30) == 1 && amounts.at(30) == 1, "histogram counts single amounts");
+  check(amounts.count(200) == 0 && amounts.count(5000) == 0, "histogram leaves locked amounts out");
+
+  check(index.unlockedAmount() == 230, "unlocked total");
+  check(index.lockedAmount() == 5200, "locked total");
+  check(index.spentAmount() == 340, "spent total");
+}
+
+void testAllLocked() {
+  std::vector<CryptoNote::TransactionOutputInformation> unspent = { makeOutput(7, 0, 10), makeOutput(7, 1, 20) };
+  std::vector<CryptoNote::TransactionOutputInformation> locked = { makeOutput(7, 1, 20), makeOutput(7, 0, 10) };
+  const OutputIndex index(std::move(unspent), std::move(locked), std::vector<CryptoNote::TransactionSpentOutputInformation>());
+  check(index.unlocked().empty(), "nothing is unlocked when every output is locked");
+  check(index.unlockedAmounts().empty(), "histogram is empty when every output is locked");
+  check(index.unlockedAmount() == 0 && index.lockedAmount() == 30, "totals when every output is locked");
+}
+
+void testLockedRefresh() {
+  std::vector<CryptoNote::TransactionOutputInformation> unspent = { makeOutput(8, 0, 10), makeOutput(8, 1, 20), makeOutput(9, 0, 40) };
+  std::vector<CryptoNote::TransactionOutputInformation> locked = { makeOutput(8, 1, 20), makeOutput(9, 0, 40) };
+  std::vector<CryptoNote::TransactionSpentOutputInformation> spent = { makeSpentOutput(5, 0, 300) };
+  const OutputIndex before(std::move(unspent), std::move(locked), std::move(spent));
+
+  check(before.hasLocked({ makeOutput(9, 0, 40), makeOutput(8, 1, 20) }), "the same locked set in another order is recognized");
+  check(!before.hasLocked({ makeOutput(9, 0, 40) }), "a smaller locked set is a change");
+  check(!before.hasLocked({ makeOutput(9, 0, 40), makeOutput(8, 0, 10) }), "another locked set of the same size is a change");
+
+  // the output of transaction 9 unlocks with a new block
+  const OutputIndex after(before, { makeOutput(8, 1, 20) });
+  check(&after.unspent() == &before.unspent() && &after.spent() == &before.spent(), "a locked refresh shares unspent and spent");
+  check(after.unlocked().size() == 2, "a locked refresh splits unlocked again");
+  check(after.unlockedAmounts().count(40) == 1, "a locked refresh updates the histogram");
+  check(after.unlockedAmount() == 50 && after.lockedAmount() == 20 && after.spentAmount() == 300, "totals after a locked refresh");
+}
+
+}
+
+int main() {
+  testEmpty();
+  testUnlockedSplit();
+  testAllLocked();
+  testLockedRefresh();
+  return WalletGui::Tests::report("OutputIndex");
+}
@@ -0,0 +1,128 @@
+// Copyright (c) 2016-2026 The Karbowanec developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// Checks of SyncProgressEstimator driven by synthetic time points: rate
+// smoothing, the sample ring, the ETA and the report and log throttles.
+// Run by ctest; exits with a non-zero status when a check fails.
+
+#include <chrono>
+#include <cmath>
+
+#include "SyncProgressEstimator.h"
+#include "TestCheck.h"
+
+using namespace WalletGui;
+using WalletGui::Tests::check;
+
+namespace {
+
+typedef SyncProgressEstimator::Clock Clock;
+
+// away from the zero time point, which the estimator treats as never
+const Clock::time_point START = Clock::time_point() + std::chrono::hours(1);
+
+bool near(double _value, double _expected, double _tolerance) {
+  return std::fabs(_value - _expected) <= _tolerance;
+}
+
+Clock::time_point at(int64_t _ms) {
+  return START + std::chrono::milliseconds(_ms);
+}
+
+// one update per second at a constant rate, starting from _height at _fromSecond
+uint32_t feed(SyncProgressEstimator& _estimator, uint32_t _height, uint32_t _blocksPerSecond, int64_t _fromSecond,
+              int64_t _seconds, uint32_t _total) {
+  for (int64_t s = 0; s < _seconds; ++s) {
+    _estimator.update(_height, _total, at((_fromSecond + s) * 1000));
+    _height += _blocksPerSecond;
+  }
+
+  return _height;
+}
+
+void testRateConvergence() {
+  SyncProgressEstimator estimator;
+  uint32_t height = feed(estimator, 0, 100, 0, 10, 1000000);
+  check(near(estimator.progress().blocksPerSecond, 100.0, 0.01), "constant rate is measured exactly");
+
+  // the ring still spans the old rate, the smoothed rate must move towards the new one and settle on it
+  const double before = estimator.progress().blocksPerSecond;
+  height = feed(estimator, height, 200, 10, 5, 1000000);
+  const double moving = estimator.progress().blocksPerSecond;
+  check(moving > before && moving < 200.0, "smoothed rate moves gradually after a rate change");
+
+  feed(estimator, height, 200, 15, 60, 1000000);
+  check(near(estimator.progress().blocksPerSecond, 200.0, 0.01), "smoothed rate converges on the new rate");
+}
+
+void testRingWrapAround() {
+  SyncProgressEstimator estimator;
+  // several times the ring size at one rate, then a full ring at another
+  uint32_t height = feed(estimator, 0, 50, 0, 100, 1000000);
+  check(near(estimator.progress().blocksPerSecond, 50.0, 0.01), "rate stays exact after the ring wrapped");
+
+  height = feed(estimator, height, 10, 100, 100, 1000000);
+  check(near(estimator.progress().blocksPerSecond, 10.0, 0.01), "old samples leave the ring as it wraps");
+
+  // updates inside the sample interval do not take ring slots
+  SyncProgressEstimator dense;
+  for (int64_t ms = 0; ms < 20000; ++ms) {
+    dense.update(static_cast<uint32_t>(ms), 1000000, at(ms));
+  }
+
+  check(near(dense.progress().blocksPerSecond, 1000.0, 1.0), "a callback per block is sampled once a second");
+}
+
+void testEta() {
+  SyncProgressEstimator estimator;
+  estimator.update(0, 1000, at(0));
+  check(estimator.progress().etaSeconds < 0, "ETA is unknown before a rate is measured");
+  check(estimator.progress().blocksPerSecond == 0.0, "rate is zero before a second sample");
+
+  estimator.update(100, 1000, at(1000));
+  check(estimator.progress().etaSeconds == 9, "ETA is the remaining blocks over the rate");
+
+  estimator.update(1000, 1000, at(2000));
+  check(estimator.progress().etaSeconds == 0, "ETA is zero at the total");
+
+  estimator.update(1001, 1000, at(3000));
+  check(estimator.progress().etaSeconds == 0, "ETA is zero past the total");
+
+  SyncProgressEstimator empty;
+  empty.update(0, 0, at(0));
+  check(empty.progress().etaSeconds == 0, "ETA is zero for an empty chain");
+
+  // a reorganization starts the measurement over
+  estimator.update(500, 1000, at(4000));
+  check(estimator.progress().blocksPerSecond == 0.0 && estimator.progress().etaSeconds < 0,
+    "going back in height resets the rate");
+}
+
+void testThrottles() {
+  SyncProgressEstimator estimator;
+  check(estimator.update(1, 100, at(0)), "first update is reported");
+  check(!estimator.update(2, 100, at(100)), "update within 500 ms is not reported");
+  check(!estimator.update(3, 100, at(499)), "update just before 500 ms is not reported");
+  check(estimator.update(4, 100, at(500)), "update at 500 ms is reported");
+  check(!estimator.update(5, 100, at(700)), "report interval restarts from the last report");
+
+  check(estimator.isLogDue(at(0)), "first log is due at once");
+  check(!estimator.isLogDue(at(1000)), "log is not due within 30 s");
+  check(!estimator.isLogDue(at(29999)), "log is not due just before 30 s");
+  check(estimator.isLogDue(at(30000)), "log is due at 30 s");
+
+  estimator.reset();
+  check(estimator.update(6, 100, at(30100)), "reset clears the report throttle");
+  check(estimator.isLogDue(at(30100)), "reset clears the log throttle");
+}
+
+}
+
+int main() {
+  testRateConvergence();
+  testRingWrapAround();
+  testEta();
+  testThrottles();
+  return WalletGui::Tests::report("SyncProgressEstimator");
+}
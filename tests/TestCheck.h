@@ -0,0 +1,37 @@
+// Copyright (c) 2016-2026 The Karbowanec developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <iostream>
+
+namespace WalletGui {
+namespace Tests {
+
+// Failed checks are reported as they happen and counted; main() returns
+// report(), which is non-zero when any of them failed.
+inline int& failures() {
+  static int count = 0;
+  return count;
+}
+
+inline void check(bool _condition, const char* _what) {
+  if (!_condition) {
+    std::cerr << "FAILED: " << _what << std::endl;
+    ++failures();
+  }
+}
+
+inline int report(const char* _subject) {
+  if (failures() != 0) {
+    std::cerr << failures() << " check(s) failed" << std::endl;
+    return 1;
+  }
+
+  std::cout << "All " << _subject << " checks passed" << std::endl;
+  return 0;
+}
+
+}
+}